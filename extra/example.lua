@@ -37,6 +37,9 @@ swayimg.imagelist.reverse = false          -- reverse order
 swayimg.imagelist.recursive = false        -- recursive directory reading
 swayimg.imagelist.adjacent = false         -- add adjacent files from same dir
 swayimg.imagelist.fsmon = true             -- enable file system monitoring
+swayimg.imagelist.fsmon_delay = 0.1        -- FS changes collection time
+swayimg.imagelist.cache = false            -- cache directory listings
+swayimg.imagelist.extensions = {}          -- allowed file extensions (all)
 
 --------------------------------------------------------------------------------
 -- Text overlay configuration
@@ -60,6 +63,7 @@ swayimg.viewer.default_position = "center" -- default image position
 swayimg.viewer.drag_button = "MouseLeft"   -- mouse button to drag image
 swayimg.viewer.autocenter = true           -- enable automatic centering
 swayimg.viewer.loop = true                 -- enable image list loop mode
+swayimg.viewer.skip_on_repeat = true       -- no decoding on key auto-repeat
 swayimg.viewer.preload = 1                 -- number of images to preload
 swayimg.viewer.history = 1                 -- number of images in history cache
 swayimg.viewer.mark_color = 0xff808080     -- mark icon color
@@ -251,7 +255,9 @@ swayimg.gallery.unselected_color = 0xff202020 -- background color for unselected
 swayimg.gallery.window_color = 0xff000000     -- window background color
 swayimg.gallery.pinch_factor = 100.0          -- pinch gesture factor
 swayimg.gallery.hover = true                  -- enable mouse following
-swayimg.gallery.cache = 100                   -- number of thumbnails stored in memory
+swayimg.gallery.smooth_scroll = false         -- pixel precise scrolling
+swayimg.gallery.cache = 100                   -- number of thumbnails to preload
+swayimg.gallery.cache_limit = 256             -- max size of thumbnails cache in MiB
 swayimg.gallery.preload = false               -- preloading invisible thumbnails
 swayimg.gallery.embedded_thumb = true         -- use embedded thumbnails
 swayimg.gallery.pstore = false                -- enable persistent storage for thumbnails
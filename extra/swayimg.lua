@@ -109,6 +109,15 @@
 ---@field height integer Height of the currently displayed frame
 ---@field meta table<string, string> Image meta info: EXIF, tags, etc
 
+---Thumbnail loader statistics.
+---@class swayimg.loader_stat
+---@field limit integer Current limit of concurrent loaders
+---@field active integer Number of active loaders
+---@field queued integer Number of thumbnails waiting in loading queue
+---@field loaded integer Total number of loaded thumbnails
+---@field rate number Loading rate in thumbnails per second
+---@field cpu number Average CPU usage by a single loader (0.0-1.0)
+
 --------------------------------------------------------------------------------
 
 ---General functionality.
@@ -243,6 +252,27 @@ function swayimg.defer(seconds, fn) end
 ---Since 5.5.
 ---@field fsmon boolean
 ---
+---Time in seconds to collect file system changes before applying them.
+---All changes within this window update the image list at once.
+---Since 5.6.
+---@field fsmon_delay number
+---
+---Persistent cache of directory listings.
+---Unchanged directories are not read again on the next start.
+---Since 5.6.
+---@field cache boolean
+---
+---Path to the directory listings cache file.
+---Since 5.6.
+---@field cache_path string
+---
+---Allowed file extensions (case insensitive).
+---Other files are skipped while scanning, so they never enter the image list.
+---Accepts a single extension or a list, empty list allows all files.
+---Since 5.6.
+---Write-only field.
+---@field extensions table
+---
 ---Total number of entries in the image list.
 ---Since 5.5.
 ---Read-only field.
@@ -269,6 +299,11 @@ function swayimg.imagelist.clear() end
 ---@return swayimg.entry[] # Array with all file entries
 function swayimg.imagelist.get() end
 
+---Get number of entries in each directory of the image list.
+---Since 5.6.
+---@return table<string, integer> # Directory paths with number of entries
+function swayimg.imagelist.dirs() end
+
 --------------------------------------------------------------------------------
 
 ---Text overlay layer.
@@ -430,6 +465,12 @@ function swayimg_appmode.on_image_change(fn) end
 ---Write-only field.
 ---@field loop boolean
 ---
+---Don't decode images while the key is auto-repeated.
+---Only the file info is shown until the key is released.
+---Since 5.6.
+---Write-only field.
+---@field skip_on_repeat boolean
+---
 ---Default image scale for newly opened images.
 ---Since 5.5.
 ---Write-only field.
@@ -646,6 +687,12 @@ swayimg.slideshow = {}
 ---Write-only field.
 ---@field hover boolean
 ---
+---Scroll thumbnails by pixels instead of whole rows on mouse wheel/touchpad.
+---Since 5.6.
+---Write-only field.
+---The selection follows the scrolling to stay within the visible rows.
+---@field smooth_scroll boolean
+---
 ---Use persistent storage for thumbnails.
 ---Since 5.5.
 ---Write-only field.
@@ -662,11 +709,26 @@ swayimg.slideshow = {}
 ---The program preloads thumbnails into the cache up to the amount specified in the `cache` field.
 ---@field preload boolean
 ---
----Max number of invisible thumbnails stored in memory cache.
+---Number of invisible thumbnails to preload.
 ---Since 5.5.
 ---Write-only field.
+---Thumbnails around the visible ones are preloaded if `preload` is enabled.
 ---@field cache integer
 ---
+---Max size of thumbnails memory cache in megabytes.
+---Since 5.6.
+---Write-only field.
+---Invisible thumbnails are evicted from the cache when it becomes full, the
+---farthest from the currently selected one first.
+---@field cache_limit integer
+---
+---Max number of concurrent thumbnail loaders.
+---Since 5.6.
+---Set to 0 (default) to adjust the number automatically depending on the CPU
+---usage by loaders: more loaders are used if they are waiting for slow I/O.
+---The getter returns the current limit.
+---@field loader_threads integer
+---
 ---Use embedded thumbnails.
 ---Since 5.5.
 ---Currently only applicable to RAW images.
@@ -710,3 +772,8 @@ function swayimg.gallery.reload() end
 ---Since 5.0.
 ---@return swayimg.entry|nil # Currently selected image entry
 function swayimg.gallery.get_image() end
+
+---Get thumbnail loader statistics.
+---Since 5.6.
+---@return swayimg.loader_stat # Loader statistics
+function swayimg.gallery.get_loader_stat() end
@@ -5,10 +5,12 @@
 #pragma once
 
 #include "geometry.hpp"
+#include "imagelist.hpp"
 #include "input.hpp"
 
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <variant>
 #include <vector>
 
@@ -21,6 +23,12 @@ struct WindowClose {};
 /** Window redraw event. */
 struct WindowRedraw {};
 
+/** Text overlay redraw event. */
+struct TextRedraw {};
+
+/** Display is ready to show the next frame. */
+struct FrameReady {};
+
 /** Window resize event. */
 struct WindowResize {
     Size size; ///< New size of the window
@@ -33,13 +41,15 @@ struct WindowRescale {
 
 /** Key press event. */
 struct KeyPress {
-    InputKeyboard key; ///< Key description
+    InputKeyboard key;   ///< Key description
+    bool repeat = false; ///< Key press is auto-repeated
 };
 
 /** Mouse clock event. */
 struct MouseClick {
-    InputMouse mouse; ///< Mouse key state
-    Point pointer;    ///< Mouse pointer coordinates within the window
+    InputMouse mouse;    ///< Mouse key state
+    Point pointer;       ///< Mouse pointer coordinates within the window
+    double scroll = 0.0; ///< Scroll distance in pixels (for scroll events)
 };
 
 /** Mouse move event. */
@@ -64,24 +74,24 @@ struct DragAndDrop {
     std::vector<std::filesystem::path> paths; ///< Paths to the files
 };
 
-/** File create event. */
-struct FileCreate {
-    std::filesystem::path path; ///< Path to the file
-};
-
-/** File change event. */
-struct FileModify {
-    std::filesystem::path path; ///< Path to the file
+/** File system change event: batch of coalesced FS monitor events. */
+struct FileChange {
+    std::vector<std::filesystem::path> create; ///< Created files
+    std::vector<std::filesystem::path> modify; ///< Modified files
+    std::vector<std::filesystem::path> remove; ///< Removed files
 };
 
-/** File remove event. */
-struct FileRemove {
-    std::filesystem::path path; ///< Path to the file
+/** Image list population event: batch of files found by background scan. */
+struct ImageListAdd {
+    std::shared_ptr<ImageList::Batch> batch; ///< Found files, nullptr at end
+    size_t generation = 0; ///< Scan generation, stale batches are dropped
 };
 
 // clang-format off
 using Holder = std::variant<WindowClose,
                             WindowRedraw,
+                            TextRedraw,
+                            FrameReady,
                             WindowResize,
                             WindowRescale,
                             KeyPress,
@@ -90,9 +100,8 @@ using Holder = std::variant<WindowClose,
                             GesturePinch,
                             Signal,
                             DragAndDrop,
-                            FileCreate,
-                            FileModify,
-                            FileRemove>;
+                            FileChange,
+                            ImageListAdd>;
 // clang-format on
 
 // event handler
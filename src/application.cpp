@@ -25,9 +25,48 @@
 #include "ui_drm.hpp"
 #endif // HAVE_DRM
 
-#include <poll.h>
+#include <sys/epoll.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <csignal>
+#include <iterator>
+
+namespace {
+
+// Period of publishing files found by the background image list scanner
+constexpr auto SCAN_PUBLISH_PERIOD = std::chrono::milliseconds(100);
+
+// Max number of descriptor events handled per main loop iteration
+constexpr size_t MAX_EPOLL_EVENTS = 16;
+
+/**
+ * Merge continuous input event (mouse move, pinch) with the previous one.
+ * @param prev previous event in the queue
+ * @param event new event
+ * @return true if the new event was merged
+ */
+bool merge_input(AppEvent::Holder& prev, const AppEvent::Holder& event)
+{
+    if (auto* move = std::get_if<AppEvent::MouseMove>(&prev)) {
+        const auto* next = std::get_if<AppEvent::MouseMove>(&event);
+        if (next && next->mouse == move->mouse) {
+            move->pointer = next->pointer;
+            move->delta = move->delta + next->delta;
+            return true;
+        }
+    } else if (auto* pinch = std::get_if<AppEvent::GesturePinch>(&prev)) {
+        const auto* next = std::get_if<AppEvent::GesturePinch>(&event);
+        if (next) {
+            pinch->scale_delta += next->scale_delta;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
 
 Application& Application::self()
 {
@@ -37,7 +76,12 @@ Application& Application::self()
 
 Application::Application()
     : sparams(new StartupParams())
+    , epoll(epoll_create1(EPOLL_CLOEXEC))
 {
+    if (epoll == -1) {
+        Log::error(errno, "Unable to create epoll instance");
+    }
+
     sparams->app_id = Defaults::app::app_id;
     sparams->mode = Defaults::app::mode;
     sparams->fullscreen = Defaults::app::fullscreen;
@@ -65,10 +109,22 @@ int Application::run()
         lua.execute(sparams->lua_exec);
     }
 
-    // initialize filemon and image list
+    // headless mode: generate thumbnails without UI
+    if (sparams->thumbs_only) {
+        ImageList::self().fsmon = false;
+        if (!il_initialize(false)) {
+            Log::warning("Image list is empty, exit");
+            return 1;
+        }
+        Gallery::self().pstore_generate();
+        return 0;
+    }
+
+    // initialize filemon and image list, the list is populated in background
     FsMonitor::self().initialize();
-    const ImageEntryPtr first_entry = il_initialize();
+    const ImageEntryPtr first_entry = il_initialize(true);
     if (!first_entry && active_mode != AppMode::Gallery) {
+        il_stop();
         Log::warning("Image list is empty, exit");
         return 1;
     }
@@ -79,6 +135,7 @@ int Application::run()
         ui.reset(ui_init_drm());
     }
     if (!ui) {
+        il_stop();
         return 1;
     }
 
@@ -88,6 +145,7 @@ int Application::run()
 
     // initialize other subsystems
     Text::self().initialize();
+    Text::self().set_overlay(ui->has_overlay());
     Viewer::self().initialize();
     Slideshow::self().initialize();
     Gallery::self().initialize();
@@ -97,7 +155,9 @@ int Application::run()
     sparams.reset();
 
     current_mode()->activate(first_entry, ui->get_window_size());
-    if (active_mode != AppMode::Gallery && !current_mode()->get_current()) {
+    if (active_mode != AppMode::Gallery && !current_mode()->get_current() &&
+        !il_scanner.joinable()) {
+        // the check is postponed to the end of scanning if it is not complete
         Log::warning("Failed to open any images, exit");
         return 1;
     }
@@ -108,9 +168,13 @@ int Application::run()
     }
 
     event_loop();
+    il_stop();
     current_mode()->deactivate();
     ui->stop();
 
+    // listings of directories added while running (drag-and-drop, FS monitor)
+    ImageList::self().save_cache();
+
     return exit_code;
 }
 
@@ -189,6 +253,8 @@ void Application::remove_images(const std::vector<std::filesystem::path>& paths)
 
 void Application::remove_all_images()
 {
+    il_stop(); // don't let the background scanner refill the list
+
     const std::vector<ImageEntryPtr> entries = ImageList::self().clear();
     if (!entries.empty()) {
         current_mode()->handle_imagelist(AppMode::ImageListEvent::Remove,
@@ -199,7 +265,17 @@ void Application::remove_all_images()
 
 void Application::add_fdpoll(const int fd, const FdEventHandler& handler)
 {
-    fds.emplace_back(fd, handler);
+    assert(fd != -1);
+
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+        Log::error(errno, "Unable to watch file descriptor {}", fd);
+        return;
+    }
+
+    fds.insert_or_assign(fd, handler);
 }
 
 void Application::add_event(const AppEvent::Holder& event)
@@ -215,11 +291,25 @@ void Application::add_event(const AppEvent::Holder& event)
             return;
         }
 
+        // text overlay is redrawn entirely, one event is enough
+        if (std::holds_alternative<AppEvent::TextRedraw>(event) &&
+            std::ranges::any_of(event_queue, [](const AppEvent::Holder& it) {
+                return std::holds_alternative<AppEvent::TextRedraw>(it);
+            })) {
+            return;
+        }
+
         // append event to queue, but preserve redraw at last position
         auto pos = event_queue.end();
         if (has_redraw) {
             --pos;
         }
+
+        // continuous input: only the final state matters
+        if (pos != event_queue.begin() && merge_input(*std::prev(pos), event)) {
+            return;
+        }
+
         event_queue.insert(pos, event);
     }
 
@@ -234,26 +324,111 @@ const std::string& Application::get_appid() const
     return app_id;
 }
 
-ImageEntryPtr Application::il_initialize() const
+ImageEntryPtr Application::il_initialize(const bool background)
 {
     assert(!sparams->sources.empty());
 
     ImageList& il = ImageList::self();
     std::vector<ImageEntryPtr> added;
 
-    const Log::PerfTimer timer;
-
     if (sparams->sources.size() == 1 && sparams->sources[0] == "-") {
         added = il.add({ ImageEntry::SRC_STDIN });
-    } else {
+    } else if (!background) {
+        const Log::PerfTimer timer;
         added = il.add(sparams->sources);
+        if (Log::verbose_enable()) {
+            Log::verbose("Image list loaded in {:.6f} sec", timer.time());
+        }
+        il.save_cache();
+    } else {
+        // the first found image is opened without waiting for the whole list,
+        // the rest is added by events from the scanning thread
+        std::promise<ImageList::Batch> first;
+        std::future<ImageList::Batch> first_batch = first.get_future();
+        il_scanner = std::thread([this, sources = sparams->sources,
+                                  options = il.get_scan_options(),
+                                  generation = il_generation,
+                                  first = std::move(first)]() mutable {
+            il_scan(sources, options, generation, first);
+        });
+        added = il.add(first_batch.get());
+    }
+
+    return added.empty() ? nullptr : added.front();
+}
+
+void Application::il_scan(const std::vector<std::filesystem::path>& sources,
+                          const ImageList::ScanOptions& options,
+                          const size_t generation,
+                          std::promise<ImageList::Batch>& first)
+{
+    const Log::PerfTimer timer;
+
+    bool first_sent = false;
+    ImageList::Batch pending;
+    auto last_publish = std::chrono::steady_clock::now();
+
+    ImageList::self().scan(sources, options, [&](ImageList::Batch&& batch) {
+        if (stop_flag || il_cancel) {
+            return false;
+        }
+
+        pending.files.insert(pending.files.end(),
+                             std::make_move_iterator(batch.files.begin()),
+                             std::make_move_iterator(batch.files.end()));
+        pending.watch.insert(pending.watch.end(),
+                             std::make_move_iterator(batch.watch.begin()),
+                             std::make_move_iterator(batch.watch.end()));
+
+        // publish the first file immediately, then limit the rate of events
+        // to not resort the list too often
+        const auto now = std::chrono::steady_clock::now();
+        if (!first_sent) {
+            if (!pending.files.empty()) {
+                first.set_value(std::move(pending));
+                pending = {};
+                first_sent = true;
+                last_publish = now;
+            }
+        } else if (now - last_publish >= SCAN_PUBLISH_PERIOD) {
+            add_event(AppEvent::ImageListAdd {
+                std::make_shared<ImageList::Batch>(std::move(pending)),
+                generation });
+            pending = {};
+            last_publish = now;
+        }
+
+        return true;
+    });
+
+    if (!first_sent) {
+        first.set_value(std::move(pending));
+    } else if (!pending.files.empty() || !pending.watch.empty()) {
+        add_event(AppEvent::ImageListAdd {
+            std::make_shared<ImageList::Batch>(std::move(pending)),
+            generation });
     }
 
     if (Log::verbose_enable()) {
         Log::verbose("Image list loaded in {:.6f} sec", timer.time());
     }
 
-    return added.empty() ? nullptr : added.front();
+    // don't delay stopping, the cache is saved on exit anyway
+    if (!stop_flag && !il_cancel) {
+        ImageList::self().save_cache();
+    }
+
+    add_event(AppEvent::ImageListAdd { nullptr, generation }); // end of scan
+}
+
+void Application::il_stop()
+{
+    if (il_scanner.joinable()) {
+        il_cancel = true;
+        il_scanner.join();
+        il_cancel = false;
+        ++il_generation; // drop batches that are still in the event queue
+    }
 }
 
 Ui* Application::ui_init_wayland() const
@@ -359,28 +534,25 @@ void Application::event_loop()
         stop_flag = true;
     });
 
-    // create fd array to poll
-    std::vector<pollfd> poll_fds;
-    poll_fds.reserve(fds.size());
-    for (auto& it : fds) {
-        poll_fds.push_back({
-            .fd = it.first,
-            .events = POLLIN,
-            .revents = 0,
-        });
-    }
-
     // main loop: handle events
     while (!stop_flag) {
-        if (poll(poll_fds.data(), poll_fds.size(), -1) < 0 && errno != EINTR) {
+        std::array<epoll_event, MAX_EPOLL_EVENTS> events;
+        const int num = epoll_wait(epoll, events.data(), events.size(), -1);
+        if (num < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
             exit_code = errno;
             Log::error(errno, "Failed to poll events");
             break;
         }
-        // call handlers for each active event
-        for (size_t i = 0; !stop_flag && i < poll_fds.size(); ++i) {
-            if (poll_fds[i].revents & POLLIN) {
-                fds[i].second();
+        // call handlers for each active descriptor only
+        for (int i = 0; !stop_flag && i < num; ++i) {
+            if (events[i].events & EPOLLIN) {
+                const auto it = fds.find(events[i].data.fd);
+                if (it != fds.end()) {
+                    it->second();
+                }
             }
         }
     }
@@ -406,6 +578,12 @@ void Application::handle_event(const AppEvent::Holder& event)
                                      decltype(event),
                                      const AppEvent::WindowRedraw&>) {
                 handle_event(event);
+            } else if constexpr (std::is_same_v<decltype(event),
+                                                const AppEvent::TextRedraw&>) {
+                handle_event(event);
+            } else if constexpr (std::is_same_v<decltype(event),
+                                                const AppEvent::FrameReady&>) {
+                handle_event(event);
             } else if constexpr (std::is_same_v<decltype(event),
                                                 const AppEvent::KeyPress&>) {
                 handle_event(event);
@@ -426,13 +604,11 @@ void Application::handle_event(const AppEvent::Holder& event)
                                                 const AppEvent::DragAndDrop&>) {
                 handle_event(event);
             } else if constexpr (std::is_same_v<decltype(event),
-                                                const AppEvent::FileCreate&>) {
+                                                const AppEvent::FileChange&>) {
                 handle_event(event);
-            } else if constexpr (std::is_same_v<decltype(event),
-                                                const AppEvent::FileModify&>) {
-                handle_event(event);
-            } else if constexpr (std::is_same_v<decltype(event),
-                                                const AppEvent::FileRemove&>) {
+            } else if constexpr (std::is_same_v<
+                                     decltype(event),
+                                     const AppEvent::ImageListAdd&>) {
                 handle_event(event);
             } else {
                 assert(false && "unhnadled event type");
@@ -455,6 +631,7 @@ void Application::handle_event(const AppEvent::WindowResize& event)
         on_wnd_resize();
     }
     redraw();
+    redraw_text();
 }
 
 // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
@@ -466,13 +643,24 @@ void Application::handle_event(const AppEvent::WindowRescale& event)
 
 void Application::handle_event(const AppEvent::WindowRedraw&)
 {
+    // render no more than one frame per display refresh, state changes made
+    // in between are drawn together by the next frame
+    if (ui->frame_pending()) {
+        redraw_deferred = true;
+        return;
+    }
+    redraw_deferred = false;
+
     Pixmap* wnd = ui->lock_surface();
     if (wnd) {
         const Log::PerfTimer timer;
 
-        current_mode()->window_redraw(*wnd);
-        Text::self().draw(*wnd);
-        ui->commit_surface();
+        std::vector<Rectangle> damage = current_mode()->window_redraw(*wnd);
+        if (!ui->has_overlay()) {
+            const std::vector<Rectangle> text = Text::self().draw(*wnd);
+            damage.insert(damage.end(), text.begin(), text.end());
+        }
+        ui->commit_surface(damage);
 
         if (on_redraw_complete) {
             on_redraw_complete();
@@ -484,9 +672,37 @@ void Application::handle_event(const AppEvent::WindowRedraw&)
     }
 }
 
+void Application::handle_event(const AppEvent::FrameReady&)
+{
+    if (redraw_deferred) {
+        redraw();
+    }
+}
+
+void Application::handle_event(const AppEvent::TextRedraw&)
+{
+    static_assert(Text::LAYERS <= Ui::MAX_OVERLAYS);
+
+    if (!ui->has_overlay()) {
+        redraw(); // text is blended on top of the window content
+        return;
+    }
+
+    // each text block has its own small layer, the window is untouched
+    const Text& text = Text::self();
+    const Size wnd = ui->get_window_size();
+    for (size_t i = 0; i < Text::LAYERS; ++i) {
+        Pixmap* layer = ui->lock_overlay(i, text.get_layer(i, wnd));
+        if (layer) {
+            text.draw_layer(i, *layer, { .x = 0, .y = 0 });
+            ui->commit_overlay(i);
+        }
+    }
+}
+
 void Application::handle_event(const AppEvent::KeyPress& event)
 {
-    if (!current_mode()->handle_keyboard(event.key) &&
+    if (!current_mode()->handle_keyboard(event.key, event.repeat) &&
         !Xkb::is_modifier(event.key.key)) {
         const std::string msg =
             std::format("Unhandled key: {}", event.key.to_string());
@@ -496,6 +712,11 @@ void Application::handle_event(const AppEvent::KeyPress& event)
 
 void Application::handle_event(const AppEvent::MouseClick& event)
 {
+    if (event.scroll != 0.0 &&
+        current_mode()->handle_scroll(event.mouse, event.pointer,
+                                      event.scroll)) {
+        return;
+    }
     if (!current_mode()->handle_mclick(event.mouse, event.pointer)) {
         const std::string msg =
             std::format("Unhandled mouse: {}", event.mouse.to_string());
@@ -531,37 +752,78 @@ void Application::handle_event(const AppEvent::DragAndDrop& event)
     }
 }
 
-void Application::handle_event(const AppEvent::FileCreate& event)
+void Application::handle_event(const AppEvent::FileChange& event)
 {
     ImageList& il = ImageList::self();
-    if (!std::filesystem::is_directory(event.path) || il.recursive) {
+
+    // ignore directories, files will be removed as standalone event
+    std::vector<std::filesystem::path> remove;
+    for (const std::filesystem::path& path : event.remove) {
+        if (!std::filesystem::is_directory(path)) {
+            remove.push_back(path);
+        }
+    }
+    if (!remove.empty()) {
+        remove_images(remove);
+    }
+
+    std::vector<std::filesystem::path> create;
+    std::vector<ImageEntryPtr> modified;
+    for (const std::filesystem::path& path : event.create) {
+        if (!std::filesystem::is_directory(path) || il.recursive) {
+            create.push_back(path);
+        }
+    }
+    for (const std::filesystem::path& path : event.modify) {
+        if (!std::filesystem::is_directory(path)) {
+            const ImageEntryPtr entry = il.find(path);
+            if (entry) {
+                modified.push_back(entry);
+            } else {
+                create.push_back(path);
+            }
+        }
+    }
+
+    if (!create.empty()) {
         // Temporarily disable `adjacent` to prevent adding unnecessary files.
         const bool adjacent = il.adjacent;
         il.adjacent = false;
-        add_images({ event.path });
+        add_images(create);
         il.adjacent = adjacent;
     }
+    if (!modified.empty()) {
+        il.refresh(modified);
+        current_mode()->handle_imagelist(AppMode::ImageListEvent::Modify,
+                                         modified);
+    }
 }
 
-void Application::handle_event(const AppEvent::FileModify& event)
+void Application::handle_event(const AppEvent::ImageListAdd& event)
 {
-    if (!std::filesystem::is_directory(event.path)) {
-        ImageList& il = ImageList::self();
-        const ImageEntryPtr entry = il.find(event.path);
-        if (entry) {
-            current_mode()->handle_imagelist(AppMode::ImageListEvent::Modify,
-                                             { entry });
-        } else {
-            add_images({ event.path });
+    if (event.generation != il_generation) {
+        return; // scanning was stopped, the list has been replaced
+    }
+
+    if (!event.batch) {
+        // background scanning complete
+        if (il_scanner.joinable()) {
+            il_scanner.join();
+        }
+        if (active_mode != AppMode::Gallery &&
+            !current_mode()->get_current()) {
+            Log::warning("Failed to open any images, exit");
+            exit(1);
         }
+        return;
     }
-}
 
-void Application::handle_event(const AppEvent::FileRemove& event)
-{
-    // ignore directories, files will be removed as standalone event
-    if (!std::filesystem::is_directory(event.path)) {
-        remove_images({ event.path });
+    const std::vector<ImageEntryPtr> entries =
+        ImageList::self().add(*event.batch);
+    if (!entries.empty()) {
+        current_mode()->handle_imagelist(AppMode::ImageListEvent::Create,
+                                         entries);
+        redraw();
     }
 }
 
@@ -13,8 +13,11 @@
 #include <atomic>
 #include <deque>
 #include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 class Application {
@@ -39,6 +42,11 @@ public:
      */
     static void redraw() { self().add_event(AppEvent::WindowRedraw {}); }
 
+    /**
+     * Redraw text overlay.
+     */
+    static void redraw_text() { self().add_event(AppEvent::TextRedraw {}); }
+
     Application();
 
     /**
@@ -90,7 +98,8 @@ public:
     void remove_all_images();
 
     /**
-     * Add file descriptor to monitor.
+     * Add file descriptor to monitor, can be called at any time from the
+     * main thread: the descriptor is watched starting from the next loop.
      * @param fd file descriptor to watch
      * @param handler callback
      */
@@ -117,9 +126,26 @@ public:
 private:
     /**
      * Initialize image list.
+     * @param background flag to scan sources in background
      * @return first image entry to open, nullptr on errors
      */
-    [[nodiscard]] ImageEntryPtr il_initialize() const;
+    [[nodiscard]] ImageEntryPtr il_initialize(const bool background);
+
+    /**
+     * Scan sources and publish found files (background thread).
+     * @param sources list of sources to scan
+     * @param options scanner settings captured before starting the thread
+     * @param generation scan generation to tag published batches
+     * @param first promise to deliver the first non empty batch
+     */
+    void il_scan(const std::vector<std::filesystem::path>& sources,
+                 const ImageList::ScanOptions& options, const size_t generation,
+                 std::promise<ImageList::Batch>& first);
+
+    /**
+     * Stop background scanning and drop its unprocessed batches.
+     */
+    void il_stop();
 
     /**
      * Initialize Wayland UI.
@@ -144,15 +170,16 @@ private:
     void handle_event(const AppEvent::WindowResize& event);
     void handle_event(const AppEvent::WindowRescale& event);
     void handle_event(const AppEvent::WindowRedraw& event);
+    void handle_event(const AppEvent::TextRedraw& event);
+    void handle_event(const AppEvent::FrameReady& event);
     void handle_event(const AppEvent::KeyPress& event);
     void handle_event(const AppEvent::MouseClick& event);
     void handle_event(const AppEvent::MouseMove& event);
     void handle_event(const AppEvent::GesturePinch& event);
     void handle_event(const AppEvent::Signal& event);
     void handle_event(const AppEvent::DragAndDrop& event);
-    void handle_event(const AppEvent::FileCreate& event);
-    void handle_event(const AppEvent::FileModify& event);
-    void handle_event(const AppEvent::FileRemove& event);
+    void handle_event(const AppEvent::FileChange& event);
+    void handle_event(const AppEvent::ImageListAdd& event);
 
     // Signal handler, see std::signal for details
     static void signal_handler(int signal);
@@ -164,18 +191,23 @@ public:
     std::function<void()> on_redraw_complete; ///< Redraw complete callback
 
 private:
-    std::unique_ptr<Ui> ui; ///< UI instance
+    std::unique_ptr<Ui> ui;       ///< UI instance
+    bool redraw_deferred = false; ///< Redraw is postponed to the next frame
 
     std::string app_id;                          ///< Application id
     AppMode::Type active_mode = AppMode::Viewer; ///< Currently active mode
 
+    std::thread il_scanner;              ///< Background image list scanner
+    std::atomic<bool> il_cancel = false; ///< Scanner cancel flag
+    size_t il_generation = 0;            ///< Current scan generation
+
     std::atomic<bool> stop_flag = false; ///< Application stop flag
     int exit_code = -1;                  ///< Application exit code
     FdEvent exit_event;                  ///< Application stop event
     FdEvent signal_fds[2];               ///< Signal notifiers (USR1/USR2)
 
-    std::vector<std::pair<int, FdEventHandler>>
-        fds; ///< Monitored file descriptors
+    Fd epoll; ///< Reactor: epoll instance for monitored file descriptors
+    std::unordered_map<int, FdEventHandler> fds; ///< Descriptor handlers
 
     std::deque<AppEvent::Holder> event_queue; ///< Event queue
     std::mutex event_mutex;                   ///< Event queue mutex
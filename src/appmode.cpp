@@ -17,11 +17,13 @@ void AppMode::activate(const ImageEntryPtr&, const Size&)
     }
 }
 
-bool AppMode::handle_keyboard(const InputKeyboard& input)
+bool AppMode::handle_keyboard(const InputKeyboard& input, const bool repeat)
 {
     const auto& bind = kbindings.find(input);
     if (bind != kbindings.end()) {
+        key_repeat = repeat;
         bind->second();
+        key_repeat = false;
         return true;
     }
     return false;
@@ -53,7 +55,7 @@ void AppMode::handle_imagelist(const ImageListEvent,
     const ImageEntryPtr entry = get_current();
     Text& text = Text::self();
     text.set_field(Text::FIELD_LIST_INDEX,
-                   entry ? std::to_string(entry->index + 1) : "");
+                   entry ? std::to_string(entry->index() + 1) : "");
     text.set_field(Text::FIELD_LIST_TOTAL,
                    std::to_string(ImageList::self().size()));
     text.update();
@@ -137,7 +139,7 @@ void AppMode::switch_current()
     Ui* ui = Application::get_ui();
     std::string title = "Swayimg: ";
     if (entry) {
-        title += entry->path.filename().string();
+        title += entry->path().filename().string();
     } else {
         title += "no image";
     }
@@ -70,17 +70,20 @@ public:
     virtual void window_resize(const Size& /*wnd*/) {}
 
     /**
-     * Window resize handler.
+     * Window redraw handler.
      * @param wnd window surface pixmap
+     * @return array of updated areas
      */
-    virtual void window_redraw(Pixmap& wnd) = 0;
+    virtual std::vector<Rectangle> window_redraw(Pixmap& wnd) = 0;
 
     /**
      * Handle key press event.
      * @param input input event description
+     * @param repeat true if key press is auto-repeated
      * @return false if event not supported
      */
-    virtual bool handle_keyboard(const InputKeyboard& input);
+    virtual bool handle_keyboard(const InputKeyboard& input,
+                                 const bool repeat);
 
     /**
      * Handle mouse click.
@@ -90,6 +93,19 @@ public:
      */
     virtual bool handle_mclick(const InputMouse& input, const Point& pos);
 
+    /**
+     * Handle mouse scroll with known distance.
+     * @param input input event description
+     * @param pos mouse pointer coordinates
+     * @param delta scroll distance in pixels
+     * @return false if event not handled (bindings are used in this case)
+     */
+    virtual bool handle_scroll(const InputMouse& /*input*/,
+                               const Point& /*pos*/, const double /*delta*/)
+    {
+        return false;
+    }
+
     /**
      * Handle mouse move.
      * @param input input event description
@@ -197,6 +213,7 @@ protected:
     argb_t mark_color;                       ///< Mark icon color
     double pinch_factor;                     ///< Pinch gesture factor
     std::array<Text::Scheme, 4> text_scheme; ///< Text layer scheme
+    bool key_repeat = false; ///< Currently handled key press is repeated
 
 private:
     std::map<InputKeyboard, InputCallback> kbindings; ///< Keyboard bindings
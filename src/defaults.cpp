@@ -11,6 +11,42 @@
 #include <cstring>
 
 namespace {
+/**
+ * Get path in the user's cache directory.
+ * @param name name of the file or directory in the cache directory
+ * @return path in the cache directory
+ */
+std::filesystem::path cache_dir_path(const char* name)
+{
+    static constexpr std::array env_paths =
+        std::to_array<std::pair<const char*, const char*>>({
+            { "XDG_CACHE_HOME", ""       },
+            { "HOME",           ".cache" }
+    });
+
+    for (auto [env_name, postfix] : env_paths) {
+        std::filesystem::path path;
+        const char* env = std::getenv(env_name);
+        if (!env) {
+            continue;
+        }
+        // use only the first directory if prefix is a list
+        const char* delim = strchr(env, ':');
+        if (!delim) {
+            path = env;
+        } else {
+            path = std::string(env, delim);
+        }
+
+        path /= postfix;
+        path /= name;
+
+        return std::filesystem::absolute(path).lexically_normal();
+    }
+
+    return {};
+}
+
 /**
  * Open next frame of the currently displayed image.
  * @param mode viewer instance
@@ -62,7 +98,7 @@ void Defaults::viewer::bind_inputs(Viewer* mode)
         InputKeyboard { .key = XKB_KEY_Delete, .mods = KEYMOD_NONE }, [mode]() {
             const ImageEntryPtr entry = mode->get_current();
             if (entry) {
-                Application::self().remove_images({ entry->path });
+                Application::self().remove_images({ entry->path() });
             }
         });
     mode->bind_input(InputKeyboard { .key = XKB_KEY_f, .mods = KEYMOD_NONE },
@@ -309,7 +345,7 @@ void Defaults::gallery::bind_inputs(Gallery* mode)
         InputKeyboard { .key = XKB_KEY_Delete, .mods = KEYMOD_NONE }, [mode]() {
             const ImageEntryPtr entry = mode->get_current();
             if (entry) {
-                Application::self().remove_images({ entry->path });
+                Application::self().remove_images({ entry->path() });
             }
         });
     mode->bind_input(InputKeyboard { .key = XKB_KEY_f, .mods = KEYMOD_NONE },
@@ -480,30 +516,10 @@ void Defaults::gallery::bind_inputs(Gallery* mode)
 
 std::filesystem::path Defaults::gallery::pstore_path()
 {
-    static constexpr std::array env_paths =
-        std::to_array<std::pair<const char*, const char*>>({
-            { "XDG_CACHE_HOME", "swayimg"        },
-            { "HOME",           ".cache/swayimg" }
-    });
-
-    for (auto [env_name, postfix] : env_paths) {
-        std::filesystem::path path;
-        const char* env = std::getenv(env_name);
-        if (!env) {
-            continue;
-        }
-        // use only the first directory if prefix is a list
-        const char* delim = strchr(env, ':');
-        if (!delim) {
-            path = env;
-        } else {
-            path = std::string(env, delim);
-        }
-
-        path /= postfix;
-
-        return std::filesystem::absolute(path).lexically_normal();
-    }
+    return cache_dir_path("swayimg");
+}
 
-    return {};
+std::filesystem::path Defaults::imglist::cache_path()
+{
+    return cache_dir_path("swayimg.dirs");
 }
@@ -36,6 +36,14 @@ namespace imglist {
     constexpr bool recursive = false;
     constexpr bool adjacent = false;
     constexpr bool fsmon = true;
+    constexpr bool cache = false;
+    constexpr size_t fsmon_delay = 100;
+
+    /**
+     * Get default path for directory listing cache.
+     * @return default path to the cache file
+     */
+    std::filesystem::path cache_path();
 }
 
 // text layer
@@ -72,6 +80,7 @@ namespace render {
 namespace viewer {
     constexpr bool auto_center = true;
     constexpr bool imagelist_loop = true;
+    constexpr bool skip_on_repeat = true;
     constexpr Viewer::Scale scale = Viewer::Scale::Optimal;
     constexpr Viewer::Position position = Viewer::Position::Center;
     constexpr argb_t window_bkg = { argb_t::max, 0, 0, 0 };
@@ -131,6 +140,7 @@ namespace gallery {
     constexpr bool hover_select = true;
     constexpr bool preload = false;
     constexpr size_t cache_size = 100;
+    constexpr size_t cache_limit = 256 * 1024 * 1024;
     constexpr bool pstore_enable = false;
     constexpr double pinch_factor = 1.0;
     constexpr argb_t mark_color = { argb_t::max, 0x80, 0x80, 0x80 };
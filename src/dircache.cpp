@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: MIT
+// Persistent cache of directory listings.
+// Copyright (C) 2026 Artem Senichev <artemsen@gmail.com>
+
+#include "dircache.hpp"
+
+#include "log.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+
+namespace {
+
+// Signature and version of the cache file
+constexpr char SIGNATURE[] = "swayimg dircache 2\n";
+constexpr size_t SIGNATURE_LEN = sizeof(SIGNATURE) - 1;
+
+/** Binary writer. */
+class Writer {
+public:
+    explicit Writer(std::string& data)
+        : data(data)
+    {
+    }
+
+    template <typename T>
+        requires std::is_integral_v<T>
+    void put(const T value)
+    {
+        const auto ptr = reinterpret_cast<const char*>(&value);
+        data.append(ptr, sizeof(value));
+    }
+
+    void put(const std::string& str)
+    {
+        put(static_cast<uint32_t>(str.size()));
+        data.append(str);
+    }
+
+private:
+    std::string& data;
+};
+
+/** Binary reader with bounds checking. */
+class Reader {
+public:
+    Reader(const std::string& data, const size_t pos)
+        : data(data)
+        , pos(pos)
+    {
+    }
+
+    template <typename T>
+        requires std::is_integral_v<T>
+    bool get(T& value)
+    {
+        if (data.size() - pos < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    bool get(std::string& str)
+    {
+        uint32_t len;
+        if (!get(len) || data.size() - pos < len) {
+            return false;
+        }
+        str.assign(data, pos, len);
+        pos += len;
+        return true;
+    }
+
+    [[nodiscard]] bool eof() const { return pos == data.size(); }
+
+private:
+    const std::string& data;
+    size_t pos;
+};
+
+} // anonymous namespace
+
+void DirCache::open(const std::filesystem::path& path)
+{
+    const std::scoped_lock lock(mutex);
+
+    if (file == path) {
+        return;
+    }
+
+    file = path;
+    dirs.clear();
+    modified = false;
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) {
+        return; // not created yet
+    }
+    const std::string data((std::istreambuf_iterator<char>(stream)),
+                           std::istreambuf_iterator<char>());
+    if (!parse(data)) {
+        Log::warning("Directory cache {} is corrupted, ignored",
+                     path.string());
+        dirs.clear();
+    }
+}
+
+bool DirCache::get(const std::filesystem::path& dir, const Stamp& stamp,
+                   Listing& listing) const
+{
+    const std::scoped_lock lock(mutex);
+
+    const auto it = dirs.find(dir.native());
+    if (it == dirs.end()) {
+        return false;
+    }
+    it->second.visited = true;
+    if (it->second.stamp != stamp) {
+        return false;
+    }
+
+    listing = it->second.listing;
+    return true;
+}
+
+void DirCache::put(const std::filesystem::path& dir, const Stamp& stamp,
+                   Listing&& listing)
+{
+    const std::scoped_lock lock(mutex);
+
+    if (file.empty()) {
+        return;
+    }
+
+    Dir& entry = dirs[dir.native()];
+    entry.stamp = stamp;
+    entry.listing = std::move(listing);
+    entry.visited = true;
+    modified = true;
+}
+
+void DirCache::save()
+{
+    const std::scoped_lock lock(mutex);
+
+    if (!modified || file.empty()) {
+        return;
+    }
+    modified = false;
+
+    // drop removed and renamed directories, visited ones are known to exist
+    std::error_code ec;
+    std::erase_if(dirs, [&ec](const auto& it) {
+        return !it.second.visited &&
+            !std::filesystem::is_directory(it.first, ec);
+    });
+
+    std::filesystem::create_directories(file.parent_path(), ec);
+
+    // write to temporary file and replace the old one
+    std::filesystem::path tmp = file;
+    tmp += ".tmp";
+    std::ofstream stream(tmp, std::ios::binary | std::ios::trunc);
+    if (stream.is_open()) {
+        const std::string data = compose();
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        stream.close();
+    }
+    if (!stream.good()) {
+        Log::warning("Unable to write directory cache {}", tmp.string());
+        std::filesystem::remove(tmp, ec);
+        return;
+    }
+
+    std::filesystem::rename(tmp, file, ec);
+    if (ec) {
+        Log::warning("Unable to save directory cache {}: {}", file.string(),
+                     ec.message());
+        std::filesystem::remove(tmp, ec);
+    }
+}
+
+bool DirCache::parse(const std::string& data)
+{
+    if (data.compare(0, SIGNATURE_LEN, SIGNATURE) != 0) {
+        return false;
+    }
+
+    Reader reader(data, SIGNATURE_LEN);
+    while (!reader.eof()) {
+        std::string path;
+        Dir dir;
+        uint32_t files;
+        uint32_t subdirs;
+        if (!reader.get(path) || !reader.get(dir.stamp.sec) ||
+            !reader.get(dir.stamp.nsec) || !reader.get(dir.listing.attrs) ||
+            !reader.get(files) || !reader.get(subdirs)) {
+            return false;
+        }
+
+        // counters are not trusted: arrays grow only with the read data
+        for (uint32_t i = 0; i < files; ++i) {
+            File& file = dir.listing.files.emplace_back();
+            int64_t mtime;
+            uint64_t size;
+            if (!reader.get(file.name) || !reader.get(mtime) ||
+                !reader.get(size)) {
+                return false;
+            }
+            file.mtime = mtime;
+            file.size = size;
+        }
+        for (uint32_t i = 0; i < subdirs; ++i) {
+            if (!reader.get(dir.listing.dirs.emplace_back())) {
+                return false;
+            }
+        }
+
+        dirs.insert_or_assign(std::move(path), std::move(dir));
+    }
+
+    return true;
+}
+
+std::string DirCache::compose() const
+{
+    std::string data(SIGNATURE, SIGNATURE_LEN);
+    Writer writer(data);
+
+    for (const auto& [path, dir] : dirs) {
+        writer.put(path);
+        writer.put(dir.stamp.sec);
+        writer.put(dir.stamp.nsec);
+        writer.put(dir.listing.attrs);
+        writer.put(static_cast<uint32_t>(dir.listing.files.size()));
+        writer.put(static_cast<uint32_t>(dir.listing.dirs.size()));
+        for (const File& it : dir.listing.files) {
+            writer.put(it.name);
+            writer.put(static_cast<int64_t>(it.mtime));
+            writer.put(static_cast<uint64_t>(it.size));
+        }
+        for (const std::string& it : dir.listing.dirs) {
+            writer.put(it);
+        }
+    }
+
+    return data;
+}
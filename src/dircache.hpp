@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: MIT
+// Persistent cache of directory listings.
+// Copyright (C) 2026 Artem Senichev <artemsen@gmail.com>
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Persistent cache of directory listings.
+ * A listing is valid while the modification time of the directory is not
+ * changed, so opening the same tree again requires only a stat call for
+ * each directory instead of reading it.
+ */
+class DirCache {
+public:
+    /** Modification time of the directory. */
+    struct Stamp {
+        int64_t sec = 0;   ///< Seconds
+        uint32_t nsec = 0; ///< Nanoseconds
+        bool operator==(const Stamp&) const = default;
+    };
+
+    /** Regular file in the directory. */
+    struct File {
+        std::string name;      ///< File name
+        std::time_t mtime = 0; ///< Modification time, 0 if not loaded
+        size_t size = 0;       ///< Size of the file, 0 if not loaded
+    };
+
+    /** Directory listing. */
+    struct Listing {
+        std::vector<File> files;       ///< Regular files
+        std::vector<std::string> dirs; ///< Nested directories
+        uint32_t attrs = 0; ///< statx mask of the loaded file attributes
+    };
+
+    /**
+     * Load cache from the file, does nothing if the file is already loaded.
+     * @param path path to the cache file
+     */
+    void open(const std::filesystem::path& path);
+
+    /**
+     * Get directory listing (thread safe).
+     * @param dir path to the directory
+     * @param stamp current modification time of the directory
+     * @param listing output listing
+     * @return false if the directory is not cached or was changed
+     */
+    bool get(const std::filesystem::path& dir, const Stamp& stamp,
+             Listing& listing) const;
+
+    /**
+     * Put directory listing to the cache (thread safe).
+     * @param dir path to the directory
+     * @param stamp modification time of the directory
+     * @param listing directory listing
+     */
+    void put(const std::filesystem::path& dir, const Stamp& stamp,
+             Listing&& listing);
+
+    /**
+     * Save cache to the file if it was changed, directories that were not
+     * used since the cache was loaded and don't exist anymore are removed.
+     */
+    void save();
+
+private:
+    /** Cached directory. */
+    struct Dir {
+        Stamp stamp;                  ///< Modification time of the directory
+        Listing listing;              ///< Directory listing
+        mutable bool visited = false; ///< Directory was used by scanner
+    };
+
+    /**
+     * Parse cache file content.
+     * @param data file content
+     * @return false if the file is corrupted
+     */
+    bool parse(const std::string& data);
+
+    /**
+     * Compose cache file content.
+     * @return file content
+     */
+    std::string compose() const;
+
+    std::filesystem::path file; ///< Path to the cache file
+    std::unordered_map<std::string, Dir> dirs; ///< Cached directories
+    bool modified = false;                     ///< Cache was changed
+    mutable std::mutex mutex;                  ///< Cache lock
+};
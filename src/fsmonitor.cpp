@@ -6,6 +6,7 @@
 
 #include "application.hpp"
 #include "buildconf.hpp"
+#include "defaults.hpp"
 #include "log.hpp"
 
 #include <unistd.h>
@@ -17,6 +18,41 @@
 #ifdef HAVE_INOTIFY
 #include <sys/inotify.h>
 #endif
+#ifdef HAVE_FANOTIFY
+#include <fcntl.h>
+#include <sys/fanotify.h>
+#include <sys/vfs.h>
+
+#include <cstring>
+
+namespace {
+
+// Events of the filesystem mark
+constexpr uint64_t FAN_EVENTS = FAN_CREATE | FAN_DELETE | FAN_MOVED_FROM |
+    FAN_MOVED_TO | FAN_CLOSE_WRITE | FAN_ONDIR;
+
+// Max number of reads per wakeup, the rest is delivered on the next one
+constexpr size_t FAN_MAX_READS = 4;
+
+static_assert(sizeof(fsid_t) == sizeof(__kernel_fsid_t));
+
+/**
+ * Compose key of the directory from its file system id and file handle.
+ * @param fsid file system id
+ * @param fh file handle of the directory
+ * @return key of the directory
+ */
+std::string fid_key(const void* fsid, const file_handle& fh)
+{
+    std::string key(static_cast<const char*>(fsid), sizeof(fsid_t));
+    key.append(reinterpret_cast<const char*>(&fh.handle_type),
+               sizeof(fh.handle_type));
+    key.append(reinterpret_cast<const char*>(fh.f_handle), fh.handle_bytes);
+    return key;
+}
+
+} // anonymous namespace
+#endif // HAVE_FANOTIFY
 
 FsMonitor& FsMonitor::self()
 {
@@ -24,6 +60,11 @@ FsMonitor& FsMonitor::self()
     return singleton;
 }
 
+FsMonitor::FsMonitor()
+    : delay(Defaults::imglist::fsmon_delay)
+{
+}
+
 #ifndef HAVE_INOTIFY
 FsMonitor::~FsMonitor() {}
 void FsMonitor::initialize() {}
@@ -31,6 +72,9 @@ void FsMonitor::add(const std::filesystem::path&) {}
 void FsMonitor::remove(const std::filesystem::path&) {}
 void FsMonitor::clear() {}
 void FsMonitor::handle_event(const inotify_event*) {}
+void FsMonitor::push(const std::filesystem::path&, const Change) {}
+void FsMonitor::schedule() {}
+void FsMonitor::flush() {}
 #else
 
 FsMonitor::~FsMonitor()
@@ -41,12 +85,19 @@ FsMonitor::~FsMonitor()
         }
         close(fd);
     }
+    if (fan_fd != -1) {
+        close(fan_fd);
+    }
 }
 
 void FsMonitor::initialize()
 {
     assert(fd == -1);
 
+#ifdef HAVE_FANOTIFY
+    fan_initialize();
+#endif
+
     fd = inotify_init1(IN_NONBLOCK);
     if (fd == -1) {
         Log::error(errno, "Unable to initialize FS monitor");
@@ -70,31 +121,62 @@ void FsMonitor::initialize()
                     pos += sizeof(inotify_event) + event->len;
                 }
             }
+            schedule();
+        });
+    }
+
+    // delivery timer is shared by both backends
+    if (fd != -1 || fan_fd != -1) {
+        Application::self().add_fdpoll(timer, [this]() {
+            timer.reset(0, 0);
+            armed = false;
+            flush();
         });
     }
 }
 
 void FsMonitor::add(const std::filesystem::path& path)
 {
-    if (fd == -1) {
+    if (fd == -1 && fan_fd == -1) {
         return; // not available
     }
 
     assert(path.is_absolute());
 
     // check if file is already watched by its parent
-    if (paths.contains(std::filesystem::is_regular_file(path)
-                           ? path.parent_path()
-                           : path)) {
+    const bool is_file = std::filesystem::is_regular_file(path);
+    const std::filesystem::path dir = is_file ? path.parent_path() : path;
+    if (paths.contains(dir) || fan_paths.contains(dir)) {
+        return;
+    }
+
+#ifdef HAVE_FANOTIFY
+    // standalone files are watched by inotify: the filesystem mark reports
+    // changes of all files in the directory
+    if (!is_file && fan_add(path)) {
         return;
     }
+#endif
+
+    if (fd == -1) {
+        return; // inotify is not available
+    }
 
     const int wd =
         inotify_add_watch(fd, path.c_str(),
                           IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVE |
                               IN_DELETE_SELF | IN_MOVE_SELF);
     if (wd == -1) {
-        Log::error(errno, "Unable to add monitoring path {}", path.string());
+        if (errno != ENOSPC) {
+            Log::error(errno, "Unable to add monitoring path {}",
+                       path.string());
+        } else if (!limit_reached) {
+            // don't flood the log for each directory of a large tree
+            limit_reached = true;
+            Log::warning("Limit of inotify watches is reached, changes in "
+                         "{} and other directories are not monitored",
+                         path.string());
+        }
         return;
     }
 
@@ -108,6 +190,12 @@ void FsMonitor::remove(const std::filesystem::path& path)
     if (it != paths.end()) {
         inotify_rm_watch(fd, it->second);
     }
+
+    const auto fan_it = fan_paths.find(path);
+    if (fan_it != fan_paths.end()) {
+        fan_dirs.erase(fan_it->second);
+        fan_paths.erase(fan_it);
+    }
 }
 
 void FsMonitor::clear()
@@ -115,6 +203,15 @@ void FsMonitor::clear()
     for (const auto& it : fds) {
         inotify_rm_watch(fd, it.first);
     }
+
+    // filesystem marks are kept, events for unknown directories are ignored
+    fan_dirs.clear();
+    fan_paths.clear();
+
+    // drop changes of the old directories that are not delivered yet
+    pending.clear();
+    timer.reset(0, 0);
+    armed = false;
 }
 
 void FsMonitor::handle_event(const inotify_event* event)
@@ -134,21 +231,205 @@ void FsMonitor::handle_event(const inotify_event* event)
         path /= event->name;
     }
 
-    // send app event
-    Application& app = Application::self();
     if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
         Log::verbose("FSMON: Create {}", path.c_str());
-        app.add_event(AppEvent::FileCreate { path });
+        push(path, Change::Create);
     } else if (event->mask &
                (IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF | IN_MOVE_SELF)) {
         Log::verbose("FSMON: Remove {}", path.c_str());
-        app.add_event(AppEvent::FileRemove { path });
+        push(path, Change::Remove);
     } else if (event->mask & IN_CLOSE_WRITE) {
         Log::verbose("FSMON: Modify {}", path.c_str());
-        app.add_event(AppEvent::FileModify { path });
+        push(path, Change::Modify);
     } else {
         assert(false && "unhandled event");
     }
 }
 
+void FsMonitor::push(const std::filesystem::path& path, const Change change)
+{
+    const auto [it, inserted] = pending.emplace(path, change);
+    if (inserted) {
+        return;
+    }
+
+    Change& state = it->second;
+    if (change == Change::Remove) {
+        state = Change::Remove;
+    } else if (state == Change::Remove) {
+        state = Change::Modify; // file was replaced
+    } else if (state != Change::Create) {
+        state = Change::Modify; // created file is still new after writing
+    }
+}
+
+void FsMonitor::schedule()
+{
+    // deliver changes after the delay, the following events are
+    // added to the same batch
+    if (!pending.empty() && !armed) {
+        if (delay) {
+            timer.reset(delay, 0);
+            armed = true;
+        } else {
+            flush();
+        }
+    }
+}
+
+void FsMonitor::flush()
+{
+    if (pending.empty()) {
+        return;
+    }
+
+    AppEvent::FileChange event;
+    for (auto& [path, change] : pending) {
+        switch (change) {
+            case Change::Create:
+                event.create.push_back(path);
+                break;
+            case Change::Modify:
+                event.modify.push_back(path);
+                break;
+            case Change::Remove:
+                event.remove.push_back(path);
+                break;
+        }
+    }
+    pending.clear();
+
+    Application::self().add_event(event);
+}
+
+#ifdef HAVE_FANOTIFY
+void FsMonitor::fan_initialize()
+{
+    fan_fd = fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME |
+                               FAN_NONBLOCK | FAN_CLOEXEC,
+                           O_RDONLY);
+    if (fan_fd == -1) {
+        Log::verbose("FSMON: fanotify is not available, use inotify");
+        return;
+    }
+
+    // epoll is level-triggered, so the handler is called again while the
+    // queue is not empty: limit the number of reads to keep the UI responsive
+    Application::self().add_fdpoll(fan_fd, [this]() {
+        size_t reads = 0;
+        while (reads < FAN_MAX_READS) {
+            alignas(fanotify_event_metadata) uint8_t buffer[4096];
+            ssize_t len = read(fan_fd, buffer, sizeof(buffer));
+            if (len < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break; // queue is empty or something went wrong
+            }
+            ++reads;
+            const fanotify_event_metadata* event =
+                reinterpret_cast<const fanotify_event_metadata*>(buffer);
+            while (FAN_EVENT_OK(event, len)) {
+                if (event->vers != FANOTIFY_METADATA_VERSION) {
+                    break;
+                }
+                handle_event(event);
+                event = FAN_EVENT_NEXT(event, len);
+            }
+        }
+        schedule();
+    });
+}
+
+bool FsMonitor::fan_add(const std::filesystem::path& path)
+{
+    if (fan_fd == -1) {
+        return false;
+    }
+
+    alignas(file_handle) uint8_t buffer[sizeof(file_handle) + MAX_HANDLE_SZ];
+    file_handle* fh = reinterpret_cast<file_handle*>(buffer);
+    fh->handle_bytes = MAX_HANDLE_SZ;
+    int mount_id;
+    if (name_to_handle_at(AT_FDCWD, path.c_str(), fh, &mount_id, 0) != 0) {
+        return false;
+    }
+
+    // one filesystem mark covers all directories on it
+    auto mount = mounts.find(mount_id);
+    if (mount == mounts.end()) {
+        std::string fsid;
+        struct statfs st;
+        if (statfs(path.c_str(), &st) == 0 &&
+            fanotify_mark(fan_fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                          FAN_EVENTS, AT_FDCWD, path.c_str()) == 0) {
+            fsid.assign(reinterpret_cast<const char*>(&st.f_fsid),
+                        sizeof(st.f_fsid));
+        } else {
+            // usually requires CAP_SYS_ADMIN
+            Log::verbose("FSMON: Unable to mark filesystem of {}: {}",
+                         path.c_str(), std::strerror(errno));
+        }
+        mount = mounts.emplace(mount_id, fsid).first;
+    }
+    if (mount->second.empty()) {
+        return false; // not supported, use inotify
+    }
+
+    std::string key = fid_key(mount->second.data(), *fh);
+    fan_paths.insert_or_assign(path, key);
+    fan_dirs.insert_or_assign(std::move(key), path);
+
+    return true;
+}
+
+void FsMonitor::handle_event(const fanotify_event_metadata* event)
+{
+    if (event->mask & FAN_Q_OVERFLOW) {
+        Log::warning("FS monitor queue overflow, some changes are lost");
+        return;
+    }
+
+    const auto* info =
+        reinterpret_cast<const fanotify_event_info_fid*>(event + 1);
+    if (event->event_len < sizeof(*event) + sizeof(*info) ||
+        info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) {
+        return;
+    }
+
+    const file_handle* fh = reinterpret_cast<const file_handle*>(info->handle);
+    const auto it = fan_dirs.find(fid_key(&info->fsid, *fh));
+    if (it == fan_dirs.end()) {
+        return; // directory is not watched
+    }
+
+    // compose full path
+    std::filesystem::path path = it->second;
+    const char* name =
+        reinterpret_cast<const char*>(fh->f_handle + fh->handle_bytes);
+    if (std::strcmp(name, ".") != 0) {
+        path /= name;
+    }
+
+    // events for the same name can be merged: check the final state
+    constexpr uint64_t created = FAN_CREATE | FAN_MOVED_TO;
+    constexpr uint64_t removed = FAN_DELETE | FAN_MOVED_FROM;
+    if ((event->mask & created) && (event->mask & removed)) {
+        const bool exists = std::filesystem::exists(path);
+        Log::verbose("FSMON: {} {}", exists ? "Modify" : "Remove",
+                     path.c_str());
+        push(path, exists ? Change::Modify : Change::Remove);
+    } else if (event->mask & created) {
+        Log::verbose("FSMON: Create {}", path.c_str());
+        push(path, Change::Create);
+    } else if (event->mask & removed) {
+        Log::verbose("FSMON: Remove {}", path.c_str());
+        push(path, Change::Remove);
+    } else if (event->mask & FAN_CLOSE_WRITE) {
+        Log::verbose("FSMON: Modify {}", path.c_str());
+        push(path, Change::Modify);
+    }
+}
+#endif // HAVE_FANOTIFY
+
 #endif // HAVE_INOTIFY
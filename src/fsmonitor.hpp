@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include "fdevent.hpp"
+
 #include <filesystem>
+#include <string>
 #include <unordered_map>
 
 struct inotify_event;
+struct fanotify_event_metadata;
 
 /** File system monitor. */
 class FsMonitor {
@@ -18,6 +22,7 @@ public:
      */
     static FsMonitor& self();
 
+    FsMonitor();
     ~FsMonitor();
 
     /**
@@ -38,20 +43,81 @@ public:
     void remove(const std::filesystem::path& path);
 
     /**
-     * Remove all file from monitor.
+     * Remove all file from monitor and drop undelivered changes.
      */
     void clear();
 
 private:
+    /** Coalesced change of the file. */
+    enum class Change : uint8_t {
+        Create,
+        Modify,
+        Remove,
+    };
+
     /**
      * Handle inotify event.
      * @param event inotify event
      */
     void handle_event(const inotify_event* event);
 
+    /**
+     * Initialize fanotify backend.
+     */
+    void fan_initialize();
+
+    /**
+     * Register directory in fanotify backend.
+     * @param path path to the directory
+     * @return false if fanotify can't be used for the path
+     */
+    bool fan_add(const std::filesystem::path& path);
+
+    /**
+     * Handle fanotify event.
+     * @param event fanotify event
+     */
+    void handle_event(const fanotify_event_metadata* event);
+
+    /**
+     * Add change to the pending batch.
+     * @param path path to the changed file
+     * @param change type of the change
+     */
+    void push(const std::filesystem::path& path, const Change change);
+
+    /**
+     * Start delivery of pending changes.
+     */
+    void schedule();
+
+    /**
+     * Send all pending changes as a single application event.
+     */
+    void flush();
+
 private:
     int fd = -1; ///< inotify file descriptor
 
+    // changes are collected during the delay window and delivered at once,
+    // so copying many files doesn't resort the list for each of them
+    std::unordered_map<std::filesystem::path, Change> pending; ///< Changes
+    FdTimer timer;      ///< Delivery timer
+    bool armed = false; ///< Delivery timer is running
+
     std::unordered_map<int, std::filesystem::path> fds;   ///< FD to path map
     std::unordered_map<std::filesystem::path, int> paths; ///< Path to FD map
+    bool limit_reached = false; ///< Limit of inotify watches is reached
+
+    // fanotify with filesystem marks doesn't need a kernel object for each
+    // directory, so large trees are not limited by max_user_watches
+    int fan_fd = -1; ///< fanotify file descriptor
+    std::unordered_map<int, std::string> mounts; ///< Mount id to FS id map
+    std::unordered_map<std::string, std::filesystem::path>
+        fan_dirs; ///< Directory handle to path map
+    std::unordered_map<std::filesystem::path, std::string>
+        fan_paths; ///< Path to directory handle map
+
+public:
+    size_t delay; ///< Time to collect changes before delivery (ms)
 };
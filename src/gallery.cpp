@@ -8,14 +8,21 @@
 #include "defaults.hpp"
 #include "imageformat.hpp"
 #include "imagelist.hpp"
+#include "log.hpp"
 #include "render.hpp"
 #include "resources.hpp"
 #include "text.hpp"
 
 #include <sys/stat.h>
+#include <time.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdlib>
 #include <format>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 
 // Limits for thumbnail size and other parameters
@@ -25,13 +32,33 @@ constexpr size_t PADDING_SIZE_MAX = 1000;
 constexpr size_t BORDER_SIZE_MAX = 100;
 constexpr double SSCALE_MAX = 10.0;
 
-// Number of threads used for loading thumbnails
-constexpr size_t THUMB_LOAD_THREADS = 4;
+// Max number of thumbnail loader threads per CPU core, used to hide latency of
+// slow storage when loaders are blocked on I/O
+constexpr size_t THUMB_THREADS_PER_CORE = 4;
+// Lower bound for average CPU usage by a single loader
+constexpr double THUMB_CPU_MIN = 1.0 / THUMB_THREADS_PER_CORE;
+// Smoothing factor for CPU usage average
+constexpr double THUMB_CPU_SMOOTH = 0.1;
+// Min time of loading rate measurement in seconds
+constexpr double THUMB_RATE_PERIOD = 1.0;
 
 // Service records in the thumbnail meta block
 constexpr const char* THUMB_META_INODE = "swayimg.inode";
 constexpr const char* THUMB_META_SIZE = "swayimg.size";
 
+/**
+ * Get current time of the specified clock.
+ * @param clock clock id
+ * @return time in seconds
+ */
+static double clock_time(const clockid_t clock)
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<double>(ts.tv_sec) +
+        static_cast<double>(ts.tv_nsec) / 1000000000;
+}
+
 Gallery& Gallery::self()
 {
     static Gallery singleton;
@@ -47,9 +74,10 @@ Gallery::Gallery()
     , clr_select(Defaults::gallery::clr_select)
     , clr_border(Defaults::gallery::clr_border)
     , hover_select(Defaults::gallery::hover_select)
-    , tpool(THUMB_LOAD_THREADS)
+    , tpool(ThreadPool::MAX_THREADS, THUMB_THREADS_PER_CORE)
     , pstore_enable(Defaults::gallery::pstore_enable)
     , pstore_path(Defaults::gallery::pstore_path())
+    , thumbs(Defaults::gallery::cache_limit)
     , preload(Defaults::gallery::preload)
     , cache_size(Defaults::gallery::cache_size)
 {
@@ -92,16 +120,8 @@ bool Gallery::select(const Point& pt)
 
 void Gallery::reload()
 {
-    // stop loader
-    tpool.cancel();
-    tpool.wait();
-
-    {
-        // clear cache
-        const std::scoped_lock lock(mutex);
-        thumbs.clear();
-    }
-
+    stop_loading();
+    thumbs.clear();
     refresh();
 }
 
@@ -185,6 +205,15 @@ void Gallery::enable_hover(const bool enable)
     hover_select = enable;
 }
 
+void Gallery::enable_smooth_scroll(const bool enable)
+{
+    layout.set_smooth(enable);
+    if (is_active()) {
+        refresh();
+        Application::redraw();
+    }
+}
+
 void Gallery::set_cache_size(const size_t size)
 {
     cache_size = size;
@@ -193,6 +222,29 @@ void Gallery::set_cache_size(const size_t size)
     }
 }
 
+void Gallery::set_cache_limit(const size_t size)
+{
+    thumbs.set_limit(size);
+}
+
+void Gallery::set_loader_threads(const size_t num)
+{
+    const std::scoped_lock lock(mutex);
+    load_threads = num;
+    start_loaders();
+}
+
+Gallery::LoaderStat Gallery::get_loader_stat()
+{
+    const std::scoped_lock lock(mutex);
+    return { .limit = loader_limit(),
+             .active = load_workers,
+             .queued = load_queue.size(),
+             .loaded = load_count,
+             .rate = load_rate,
+             .cpu = load_cpu };
+}
+
 void Gallery::enable_preload(const bool enable)
 {
     preload = enable;
@@ -216,6 +268,7 @@ void Gallery::initialize() {}
 void Gallery::activate(const ImageEntryPtr& entry, const Size& wnd)
 {
     AppMode::activate(entry, wnd);
+    drawn_frame = {}; // window was drawn by another mode
     layout.select(entry && !entry->removed ? entry : nullptr);
     layout.set_window_size(wnd);
     set_current(entry);
@@ -223,8 +276,7 @@ void Gallery::activate(const ImageEntryPtr& entry, const Size& wnd)
 
 void Gallery::deactivate()
 {
-    tpool.cancel();
-    tpool.wait();
+    stop_loading();
 }
 
 ImageEntryPtr Gallery::get_current()
@@ -246,29 +298,137 @@ void Gallery::window_resize(const Size& wnd)
     refresh();
 }
 
-void Gallery::window_redraw(Pixmap& wnd)
+std::vector<Rectangle> Gallery::window_redraw(Pixmap& wnd)
 {
+    const Rectangle wnd_area { 0, 0, wnd.width(), wnd.height() };
+
     const ImageEntryPtr current = layout.get_selected();
     if (!current) {
+        drawn_frame = {};
+        drawn_tiles.clear();
+        drawn_scroll = 0;
         draw_empty(wnd, clr_window);
-        return;
-    }
-
-    wnd.fill({ 0, 0, wnd.width(), wnd.height() }, clr_window);
-
+        return { wnd_area };
+    }
+
+    const FrameState frame = { .buffer = wnd.ptr(0, 0),
+                               .size = wnd,
+                               .tile_size = layout.get_thumb_size(),
+                               .aspect = aspect,
+                               .border_size = border_size,
+                               .selected_scale = selected_scale,
+                               .clr_window = clr_window,
+                               .clr_background = clr_background,
+                               .clr_select = clr_select,
+                               .clr_border = clr_border,
+                               .clr_mark = mark_color,
+                               .smooth = layout.get_smooth() };
+
+    // get current state of all tiles, the selected one is the last to be
+    // drawn on top of others
     const auto& scheme = layout.get_scheme();
-    size_t selected_scheme_idx = 0;
-    size_t i = 0;
-    // draw all exclude the currently selected
+    std::vector<TileState> tiles;
+    tiles.reserve(scheme.size());
+    const Layout::Thumbnail* selected = nullptr;
     for (const auto& it : scheme) {
         if (it.img == current) {
-            selected_scheme_idx = i;
+            selected = &it;
         } else {
-            draw(it, wnd);
-            i++;
+            tiles.emplace_back(get_tile(it, wnd));
         }
     }
-    draw(scheme[selected_scheme_idx], wnd);
+    if (selected) {
+        tiles.emplace_back(get_tile(*selected, wnd));
+    }
+
+    // move already drawn content on scrolling, only the exposed strip and
+    // changed tiles need to be redrawn
+    const size_t scroll = layout.get_scroll();
+    const ssize_t dy = static_cast<ssize_t>(scroll) -
+        static_cast<ssize_t>(drawn_scroll);
+    const bool blit = frame == drawn_frame && frame.smooth && dy != 0 &&
+        std::cmp_less(std::abs(dy), wnd.height());
+    Rectangle exposed;
+    if (blit) {
+        wnd.shift_vertical(-dy);
+        for (TileState& it : drawn_tiles) {
+            it.tile.y -= dy;
+        }
+        for (Rectangle& it : drawn_text) {
+            it.y -= dy;
+        }
+        exposed = { 0, dy > 0 ? static_cast<ssize_t>(wnd.height()) - dy : 0,
+                    wnd.width(), static_cast<size_t>(std::abs(dy)) };
+    }
+    drawn_scroll = scroll;
+
+    // get areas to redraw
+    std::vector<Rectangle> damage;
+    std::vector<bool> redraw(tiles.size(), true);
+    if (frame == drawn_frame) {
+        damage = get_damage(tiles, wnd);
+        if (blit) {
+            damage.push_back(exposed);
+        }
+        // tiles intersecting redrawn areas must be redrawn too, that in turn
+        // expands the redrawn area
+        redraw.assign(tiles.size(), false);
+        size_t redraw_count = 0;
+        bool expanded = true;
+        while (expanded && redraw_count <= tiles.size() / 2) {
+            expanded = false;
+            for (size_t i = 0; i < tiles.size(); ++i) {
+                if (redraw[i]) {
+                    continue;
+                }
+                const Rectangle area = get_tile_area(tiles[i]);
+                for (const Rectangle& dmg : damage) {
+                    if (area.intersect(dmg)) {
+                        redraw[i] = true;
+                        ++redraw_count;
+                        damage.push_back(area);
+                        expanded = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (redraw_count > tiles.size() / 2) {
+            // too many changes, full redraw is cheaper
+            damage.clear();
+            redraw.assign(tiles.size(), true);
+        }
+    }
+
+    // clear background of the redrawn areas
+    if (std::find(redraw.begin(), redraw.end(), false) == redraw.end()) {
+        damage = { wnd_area };
+    } else {
+        std::erase_if(damage, [&wnd_area](Rectangle& area) {
+            area = area.intersect(wnd_area);
+            return !area;
+        });
+    }
+    for (const Rectangle& area : damage) {
+        wnd.fill(area, clr_window);
+    }
+
+    // draw tiles
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (redraw[i]) {
+            draw(tiles[i], wnd);
+        }
+    }
+
+    drawn_frame = frame;
+    drawn_tiles = std::move(tiles);
+    drawn_text = Text::self().get_areas(wnd);
+
+    if (blit) {
+        damage = { wnd_area }; // the whole buffer was moved
+    }
+
+    return damage;
 }
 
 void Gallery::handle_mmove(const InputMouse&, const Point& pos, const Point&)
@@ -278,6 +438,27 @@ void Gallery::handle_mmove(const InputMouse&, const Point& pos, const Point&)
     }
 }
 
+bool Gallery::handle_scroll(const InputMouse& input, const Point&,
+                            const double delta)
+{
+    if (!layout.get_smooth() || input.mods != KEYMOD_NONE ||
+        (input.buttons != InputMouse::SCROLL_UP &&
+         input.buttons != InputMouse::SCROLL_DOWN)) {
+        return false;
+    }
+
+    const ImageEntryPtr prev = layout.get_selected();
+    if (layout.scroll(static_cast<ssize_t>(std::round(delta)))) {
+        refresh();
+        if (prev != layout.get_selected()) {
+            switch_current();
+        }
+        Application::redraw();
+    }
+
+    return true;
+}
+
 void Gallery::handle_pinch(const double scale_delta)
 {
     set_thumb_size(get_thumb_size() + scale_delta * pinch_factor);
@@ -290,12 +471,19 @@ void Gallery::handle_imagelist(const ImageListEvent event,
 
     if (event == ImageListEvent::Modify || event == ImageListEvent::Remove) {
         // remove entry from cache
-        const std::scoped_lock lock(mutex);
         for (const auto& entry : entries) {
             thumbs.erase(entry);
         }
     }
 
+    {
+        const std::scoped_lock lock(mutex);
+        // indices were changed, rebuild loading queue from scratch
+        load_queue.clear();
+        load_first = 1;
+        load_last = 0;
+    }
+
     if (event == ImageListEvent::Create) {
         if (!layout.get_selected()) {
             layout.select(entries.front());
@@ -316,14 +504,11 @@ void Gallery::handle_imagelist(const ImageListEvent event,
     Application::redraw();
 }
 
-void Gallery::draw(const Layout::Thumbnail& tlay, Pixmap& wnd)
+Gallery::TileState Gallery::get_tile(const Layout::Thumbnail& tlay,
+                                     const Size& wnd) const
 {
-    const std::scoped_lock lock(mutex);
-
     const bool selected = (tlay.img == layout.get_selected());
-    const Size wnd_size = wnd;
     const size_t tile_size = layout.get_thumb_size();
-    const Pixmap* pm = get_thumbnail(tlay.img);
 
     // calculate tile position/size
     Rectangle tile {
@@ -336,20 +521,77 @@ void Gallery::draw(const Layout::Thumbnail& tlay, Pixmap& wnd)
         tile.y -= tile.height / 2 - tile_size / 2;
 
         // prevent going beyond the window
-        if (tile.x + tile.width + border_size > wnd_size.width) {
-            tile.x = wnd_size.width - tile.width - border_size;
+        if (tile.x + tile.width + border_size > wnd.width) {
+            tile.x = wnd.width - tile.width - border_size;
         }
         if (std::cmp_less(tile.x, border_size)) {
             tile.x = border_size;
         }
-        if (tile.y + tile.height + border_size > wnd_size.height) {
-            tile.y = wnd_size.height - tile.height - border_size;
+        if (tile.y + tile.height + border_size > wnd.height) {
+            tile.y = wnd.height - tile.height - border_size;
         }
         if (std::cmp_less(tile.y, border_size)) {
             tile.y = border_size;
         }
     }
 
+    return { .img = tlay.img,
+             .thumb = thumbs.get(tlay.img),
+             .tile = tile,
+             .selected = selected,
+             .mark = tlay.img->mark };
+}
+
+Rectangle Gallery::get_tile_area(const TileState& tile) const
+{
+    Rectangle area = tile.tile;
+    if (tile.selected) {
+        area.x -= border_size;
+        area.y -= border_size;
+        area.width += border_size * 2;
+        area.height += border_size * 2;
+    }
+    return area;
+}
+
+std::vector<Rectangle> Gallery::get_damage(const std::vector<TileState>& tiles,
+                                           const Size& wnd) const
+{
+    // text overlay is blended on top of the tiles, so the areas under the
+    // previous and the next text must be redrawn
+    std::vector<Rectangle> damage = Text::self().get_areas(wnd);
+    damage.insert(damage.end(), drawn_text.begin(), drawn_text.end());
+
+    // compare tiles with the last drawn state
+    std::unordered_map<ImageEntryPtr, const TileState*> prev;
+    for (const TileState& it : drawn_tiles) {
+        prev.emplace(it.img, &it);
+    }
+    for (const TileState& it : tiles) {
+        const auto old = prev.find(it.img);
+        if (old == prev.end()) {
+            damage.push_back(get_tile_area(it));
+        } else {
+            if (*old->second != it) {
+                damage.push_back(get_tile_area(*old->second));
+                damage.push_back(get_tile_area(it));
+            }
+            prev.erase(old);
+        }
+    }
+    for (const auto& [_, it] : prev) {
+        damage.push_back(get_tile_area(*it)); // not visible anymore
+    }
+
+    return damage;
+}
+
+void Gallery::draw(const TileState& tstate, Pixmap& wnd)
+{
+    const bool selected = tstate.selected;
+    const Rectangle& tile = tstate.tile;
+    const Pixmap* pm = tstate.thumb.get();
+
     // draw background
     Rectangle bkg = tile;
     if (aspect == Aspect::Keep && pm && pm->width() != pm->height()) {
@@ -372,12 +614,18 @@ void Gallery::draw(const Layout::Thumbnail& tlay, Pixmap& wnd)
             ? std::max(scale_w, scale_h)
             : std::min(scale_w, scale_h);
 
+        // partially visible tile is clipped by the window, so the position
+        // is relative to the visible part of the tile
+        const Rectangle visible =
+            Rectangle { 0, 0, wnd.width(), wnd.height() }.intersect(tile);
         const Point pos { .x = static_cast<ssize_t>(tile.width / 2) -
-                              static_cast<ssize_t>(scale * pm->width()) / 2,
+                              static_cast<ssize_t>(scale * pm->width()) / 2 -
+                              (visible.x - tile.x),
                           .y = static_cast<ssize_t>(tile.height / 2) -
-                              static_cast<ssize_t>(scale * pm->height()) / 2 };
+                              static_cast<ssize_t>(scale * pm->height()) / 2 -
+                              (visible.y - tile.y) };
 
-        Pixmap sub = wnd.submap(tile);
+        Pixmap sub = wnd.submap(visible);
         Render::self().draw(sub, *pm, pos, scale);
     } else if (bkg.width > Resource::file.width() &&
                bkg.height > Resource::file.height()) {
@@ -401,7 +649,7 @@ void Gallery::draw(const Layout::Thumbnail& tlay, Pixmap& wnd)
     }
 
     // draw mark icon
-    if (tlay.img->mark) {
+    if (tstate.mark) {
         const ssize_t margin = 5;
         const ssize_t x = bkg.x + static_cast<ssize_t>(bkg.width) -
             static_cast<ssize_t>(Resource::mark.width()) - margin;
@@ -413,96 +661,170 @@ void Gallery::draw(const Layout::Thumbnail& tlay, Pixmap& wnd)
 
 void Gallery::refresh()
 {
+    const std::vector<Layout::Thumbnail>& scheme = layout.get_scheme();
+    if (scheme.empty()) {
+        thumbs.clear();
+    } else {
+        // protect visible thumbnails from eviction
+        thumbs.set_focus(scheme.front().img->index(),
+                         scheme.back().img->index(),
+                         layout.get_selected()->index());
+        thumbs.shrink();
+    }
+
     const std::scoped_lock lock(mutex);
-    clear_invisible();
     requeue_loading();
 }
 
 void Gallery::requeue_loading()
 {
-    tpool.cancel();
-
     const std::vector<Layout::Thumbnail>& scheme = layout.get_scheme();
     if (scheme.empty()) {
+        load_queue.clear();
+        load_first = 1;
+        load_last = 0;
         return;
     }
 
-    const size_t index_first = scheme.front().img->index;
-    const size_t index_last = scheme.back().img->index;
-
-    size_t preload_counter = preload ? cache_size : 0;
+    // loading window: visible thumbnails and preloaded ones around them
+    const size_t visible_first = scheme.front().img->index();
+    const size_t visible_last = scheme.back().img->index();
+    size_t first = visible_first;
+    size_t last = visible_last;
+    if (preload) {
+        const size_t half = cache_size / 2;
+        first = visible_first > half ? visible_first - half : 0;
+        last = visible_last + cache_size - half;
+    }
 
-    ImageList& il = ImageList::self();
-    ImageEntryPtr fwd = layout.get_selected();
-    ImageEntryPtr back = il.get(fwd, ImageList::Dir::Prev);
+    // drop entries that have left the window
+    load_queue.erase(load_queue.begin(), load_queue.lower_bound(first));
+    load_queue.erase(load_queue.upper_bound(last), load_queue.end());
 
-    // put thumbnail to loading queue, returns next thumb to load
-    auto queue_thumbnail = [&](const ImageEntryPtr& entry,
-                               const ImageList::Dir dir) -> ImageEntryPtr {
-        if (!get_thumbnail(entry) && !crld_thumbs.contains(entry)) {
-            tpool.add([this, entry]() {
-                load_thumbnail(entry);
-            });
-        }
-        ImageEntryPtr next = nullptr;
-        if (--preload_counter) {
-            next = il.get(entry, dir);
-            if (next &&
-                ((dir == ImageList::Dir::Next && next->index > index_last) ||
-                 (dir == ImageList::Dir::Prev && next->index < index_first))) {
-                next = nullptr;
+    // put newly exposed entries to the queue
+    auto enqueue = [this](const size_t from, const size_t to) {
+        for (const ImageEntryPtr& entry :
+             ImageList::self().get_range(from, to)) {
+            if (!thumbs.contains(entry) && !crld_thumbs.contains(entry)) {
+                load_queue.emplace(entry->index(), entry);
             }
         }
-        return next;
     };
-
-    while (fwd || back) {
-        if (fwd) {
-            fwd = queue_thumbnail(fwd, ImageList::Dir::Next);
+    // the whole window is checked again if the cache has evicted thumbnails,
+    // some of them could be inside the window
+    const size_t evicted = thumbs.get_evicted();
+    if (load_first > load_last || last < load_first || first > load_last ||
+        evicted != load_evicted) {
+        load_evicted = evicted;
+        enqueue(first, last);
+    } else {
+        if (first < load_first) {
+            enqueue(first, load_first - 1);
         }
-        if (back) {
-            back = queue_thumbnail(back, ImageList::Dir::Prev);
+        if (last > load_last) {
+            enqueue(load_last + 1, last);
         }
     }
+    load_first = first;
+    load_last = last;
+
+    // reprioritize: the nearest to the selected entry are loaded first
+    load_center = layout.get_selected()->index();
+
+    start_loaders();
 }
 
-void Gallery::clear_invisible()
+void Gallery::stop_loading()
 {
-    const std::vector<Layout::Thumbnail>& scheme = layout.get_scheme();
-    if (scheme.empty()) {
-        thumbs.clear();
-        return;
+    {
+        const std::scoped_lock lock(mutex);
+        load_queue.clear();
+        load_first = 1;
+        load_last = 0;
     }
+    tpool.wait();
+}
 
-    if (thumbs.size() > scheme.size() + cache_size) {
-        const size_t visible_first = scheme.front().img->index;
-        const size_t visible_last = scheme.back().img->index;
-        const size_t store_min =
-            visible_first > cache_size / 2 ? visible_first - cache_size / 2 : 1;
-        const size_t store_max = visible_last + cache_size - cache_size / 2;
-
-        std::erase_if(thumbs,
-                      [store_min, store_max](
-                          const std::pair<ImageEntryPtr, Pixmap>& key_value) {
-                          return key_value.first->index < store_min ||
-                              key_value.first->index > store_max;
-                      });
+void Gallery::start_loaders()
+{
+    const size_t limit = std::min(loader_limit(), load_queue.size());
+    if (load_workers == 0 && limit) {
+        // new loading session
+        rate_start = clock_time(CLOCK_MONOTONIC);
+        rate_count = 0;
+    }
+    while (load_workers < limit) {
+        ++load_workers;
+        tpool.add([this]() {
+            loader();
+        });
     }
 }
 
-const Pixmap* Gallery::get_thumbnail(const ImageEntryPtr& entry)
+size_t Gallery::loader_limit() const
 {
-    const auto it = thumbs.find(entry);
-    return it == thumbs.end() ? nullptr : &it->second;
+    if (load_threads) {
+        return std::min(load_threads, tpool.size());
+    }
+
+    // keep all CPU cores busy: the less CPU time a loader uses (i.e. it waits
+    // for I/O), the more concurrent loaders are needed
+    const double cores = std::max(1U, std::thread::hardware_concurrency());
+    const double limit = std::ceil(cores / std::max(load_cpu, THUMB_CPU_MIN));
+    return std::clamp(static_cast<size_t>(limit), static_cast<size_t>(1),
+                      tpool.size());
 }
 
-void Gallery::load_thumbnail(const ImageEntryPtr& entry)
+void Gallery::loader()
 {
-    {
-        const std::scoped_lock lock(mutex);
+    std::unique_lock lock(mutex);
+
+    while (!load_queue.empty() && load_workers <= loader_limit()) {
+        // get the entry nearest to the center
+        auto it = load_queue.lower_bound(load_center);
+        if (it == load_queue.end()) {
+            --it;
+        } else if (it != load_queue.begin()) {
+            const auto prev = std::prev(it);
+            if (load_center - prev->first < it->first - load_center) {
+                it = prev;
+            }
+        }
+        const ImageEntryPtr entry = it->second;
+        load_queue.erase(it);
         crld_thumbs.insert(entry);
+
+        lock.unlock();
+        const double wall_start = clock_time(CLOCK_MONOTONIC);
+        const double cpu_start = clock_time(CLOCK_THREAD_CPUTIME_ID);
+        load_thumbnail(entry);
+        const double cpu = clock_time(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+        const double wall_end = clock_time(CLOCK_MONOTONIC);
+        const double wall = wall_end - wall_start;
+        lock.lock();
+
+        // update statistics
+        ++load_count;
+        if (wall > 0) {
+            const double usage = std::min(cpu / wall, 1.0);
+            load_cpu += (usage - load_cpu) * THUMB_CPU_SMOOTH;
+        }
+        ++rate_count;
+        if (wall_end - rate_start >= THUMB_RATE_PERIOD) {
+            load_rate = rate_count / (wall_end - rate_start);
+            rate_start = wall_end;
+            rate_count = 0;
+        }
+
+        // adapt number of loaders to the current load type
+        start_loaders();
     }
 
+    --load_workers;
+}
+
+void Gallery::load_thumbnail(const ImageEntryPtr& entry)
+{
     const size_t thumb_size = layout.get_thumb_size();
 
     Pixmap pm;
@@ -515,26 +837,110 @@ void Gallery::load_thumbnail(const ImageEntryPtr& entry)
         pm = FormatFactory::self().preview(entry, thumb_size,
                                            aspect == Aspect::Fill);
         if (!pm) {
-            Application::self().add_event(AppEvent::FileRemove { entry->path });
+            AppEvent::FileChange event;
+            event.remove.push_back(entry->path());
+            Application::self().add_event(event);
         } else if (pstore_enable && !entry->is_special()) {
             pstore_save(entry, pm);
         }
     }
 
+    const bool loaded = pm;
+    if (loaded) {
+        thumbs.put(entry, std::move(pm));
+    }
+
     const std::scoped_lock lock(mutex);
     crld_thumbs.erase(entry);
-    if (pm) {
-        thumbs.insert_or_assign(entry, pm);
-        if (layout.is_visible(entry)) {
-            Application::redraw();
-        }
+    if (loaded && layout.is_visible(entry)) {
+        Application::redraw();
     }
 }
 
-Pixmap Gallery::pstore_load(const ImageEntryPtr& entry) const
+void Gallery::pstore_generate()
+{
+    const std::vector<ImageEntryPtr> entries = ImageList::self().get_all();
+    const size_t total = entries.size();
+    if (!total) {
+        return;
+    }
+    if (!pstore_enable) {
+        Log::warning("Persistent storage is disabled, generated thumbnails "
+                     "will not be used by gallery");
+    }
+
+    const Log::PerfTimer timer;
+    const size_t thumb_size = layout.get_thumb_size();
+    const bool fill = aspect == Aspect::Fill;
+
+    std::atomic<size_t> processed = 0;
+    std::atomic<size_t> created = 0;
+    std::atomic<size_t> skipped = 0;
+    std::atomic<size_t> failed = 0;
+    std::mutex progress_mutex;
+    size_t progress_last = 0;
+
+    ThreadPool pool(ThreadPool::MAX_THREADS);
+    Log::info("Generating {} thumbnails in {} using {} threads", total,
+              pstore_path.string(), pool.size());
+
+    for (const ImageEntryPtr& entry : entries) {
+        pool.add([&, entry]() {
+            const char* state;
+            if (entry->is_special()) {
+                ++skipped;
+                state = "skipped";
+            } else if (pstore_fresh(entry)) {
+                ++skipped;
+                state = "up to date";
+            } else {
+                const Pixmap pm =
+                    FormatFactory::self().preview(entry, thumb_size, fill);
+                if (pm) {
+                    pstore_save(entry, pm);
+                    ++created;
+                    state = "created";
+                } else {
+                    ++failed;
+                    state = "failed";
+                }
+            }
+            Log::verbose("Thumbnail {}: {}", entry->path().string(), state);
+
+            // print progress for each percent
+            const size_t done = ++processed;
+            const size_t percent = done * 100 / total;
+            const std::scoped_lock lock(progress_mutex);
+            if (percent > progress_last || done == total) {
+                progress_last = percent;
+                Log::info("[{:3}%] {} of {}", percent, done, total);
+            }
+        });
+    }
+    pool.wait();
+
+    Log::info("Thumbnails: {} created, {} up to date or skipped, {} failed",
+              created.load(), skipped.load(), failed.load());
+    if (Log::verbose_enable()) {
+        Log::verbose("Thumbnails generated in {:.6f} sec", timer.time());
+    }
+}
+
+std::filesystem::path Gallery::pstore_file(const ImageEntryPtr& entry) const
 {
     std::filesystem::path thumb_path = pstore_path;
-    thumb_path.concat(entry->path.string());
+    thumb_path.concat(entry->path().string());
+    return thumb_path;
+}
+
+bool Gallery::pstore_fresh(const ImageEntryPtr& entry) const
+{
+    return !!pstore_load(entry);
+}
+
+Pixmap Gallery::pstore_load(const ImageEntryPtr& entry) const
+{
+    const std::filesystem::path thumb_path = pstore_file(entry);
 
     if (!std::filesystem::exists(thumb_path)) {
         return {};
@@ -543,7 +949,7 @@ Pixmap Gallery::pstore_load(const ImageEntryPtr& entry) const
     // get file stats
     struct stat st_image;
     struct stat st_thumb;
-    if (stat(entry->path.c_str(), &st_image) == -1 ||
+    if (stat(entry->path().c_str(), &st_image) == -1 ||
         stat(thumb_path.c_str(), &st_thumb) == -1) {
         return {};
     }
@@ -555,7 +961,7 @@ Pixmap Gallery::pstore_load(const ImageEntryPtr& entry) const
 
     // load thumbnail
     const ImageEntryPtr thumb_entry = std::make_shared<ImageEntry>();
-    thumb_entry->path = thumb_path;
+    thumb_entry->set_path(thumb_path);
     const ImagePtr thumb_image = FormatFactory::self().load(thumb_entry);
     if (!thumb_image) {
         return {};
@@ -588,13 +994,13 @@ void Gallery::pstore_save(const ImageEntryPtr& entry, const Pixmap& thumb) const
     // fill meta info
     std::unordered_map<std::string, std::string> meta;
     struct stat st {};
-    stat(entry->path.c_str(), &st);
+    stat(entry->path().c_str(), &st);
     meta.insert_or_assign(THUMB_META_INODE, std::format("{}", st.st_ino));
     meta.insert_or_assign(THUMB_META_SIZE, std::format("{}", st.st_size));
 
     // save thumbnail
-    std::filesystem::path thumb_path = pstore_path;
-    thumb_path.concat(entry->path.string());
-    std::filesystem::create_directories(thumb_path.parent_path());
+    const std::filesystem::path thumb_path = pstore_file(entry);
+    std::error_code ec;
+    std::filesystem::create_directories(thumb_path.parent_path(), ec);
     FormatFactory::save(thumb, meta, thumb_path);
 }
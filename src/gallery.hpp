@@ -8,10 +8,11 @@
 #include "image.hpp"
 #include "layout.hpp"
 #include "threadpool.hpp"
+#include "thumbcache.hpp"
 
+#include <map>
 #include <mutex>
 #include <set>
-#include <unordered_map>
 
 class Gallery : public AppMode {
 public:
@@ -22,6 +23,16 @@ public:
         Keep, ///< Adjust thumbnail size to the aspect ratio of the image
     };
 
+    /** Thumbnail loader statistics. */
+    struct LoaderStat {
+        size_t limit;  ///< Current limit of concurrent loaders
+        size_t active; ///< Number of active loaders
+        size_t queued; ///< Number of thumbnails in loading queue
+        size_t loaded; ///< Total number of loaded thumbnails
+        double rate;   ///< Loading rate (thumbnails per second)
+        double cpu;    ///< Average CPU usage by a single loader (0.0-1.0)
+    };
+
     /**
      * Get global instance of the gallery.
      * @return gallery instance
@@ -120,11 +131,35 @@ public:
     void enable_hover(const bool enable);
 
     /**
-     * Set number of thumbnails stored in memory cache.
-     * @param size max number of thumbnails stored in memory cache
+     * Enable/disable smooth (pixel precise) scrolling.
+     * @param enable flag to set
+     */
+    void enable_smooth_scroll(const bool enable);
+
+    /**
+     * Set number of invisible thumbnails to preload.
+     * @param size number of invisible thumbnails around the visible ones
      */
     void set_cache_size(const size_t size);
 
+    /**
+     * Set max size of the thumbnail memory cache.
+     * @param size max size of the cache in bytes
+     */
+    void set_cache_limit(const size_t size);
+
+    /**
+     * Set max number of concurrent thumbnail loaders.
+     * @param num max number of loaders, 0 to adjust automatically
+     */
+    void set_loader_threads(const size_t num);
+
+    /**
+     * Get thumbnail loader statistics.
+     * @return loader statistics
+     */
+    LoaderStat get_loader_stat();
+
     /**
      * Enable preloading invisible thumbnails.
      * @param enable flag to set
@@ -143,6 +178,12 @@ public:
      */
     void set_pstore_path(const std::filesystem::path& path);
 
+    /**
+     * Generate thumbnails for all entries of the image list and save them in
+     * persistent storage, used in headless mode.
+     */
+    void pstore_generate();
+
     // app mode interface implementation
     void initialize() override;
     void activate(const ImageEntryPtr& entry, const Size& wnd) override;
@@ -150,20 +191,76 @@ public:
     ImageEntryPtr get_current() override;
     bool set_current(const ImageEntryPtr& entry) override;
     void window_resize(const Size& wnd) override;
-    void window_redraw(Pixmap& wnd) override;
+    std::vector<Rectangle> window_redraw(Pixmap& wnd) override;
     void handle_mmove(const InputMouse& input, const Point& pos,
                       const Point& delta) override;
+    bool handle_scroll(const InputMouse& input, const Point& pos,
+                       const double delta) override;
     void handle_pinch(const double scale_delta) override;
     void handle_imagelist(const ImageListEvent event,
                           const std::vector<ImageEntryPtr>& entries) override;
 
 private:
+    /** State of the drawn tile, used to detect changes between redraws. */
+    struct TileState {
+        ImageEntryPtr img;           ///< Image entry
+        ThumbCache::Thumbnail thumb; ///< Thumbnail (nullptr if not loaded)
+        Rectangle tile;              ///< Tile position and size
+        bool selected;               ///< Selection state
+        bool mark;                   ///< Mark state
+
+        bool operator==(const TileState& other) const = default;
+    };
+
+    /** Parameters affecting all tiles. */
+    struct FrameState {
+        const void* buffer = nullptr; ///< Window buffer
+        Size size;                    ///< Window size
+        size_t tile_size;             ///< Thumbnail size
+        Aspect aspect;                ///< Thumbnail aspect ratio
+        size_t border_size;           ///< Selected tile border size
+        double selected_scale;        ///< Selected tile scale
+        argb_t clr_window;            ///< Window background
+        argb_t clr_background;        ///< Tile background
+        argb_t clr_select;            ///< Selected tile background
+        argb_t clr_border;            ///< Selected tile border
+        argb_t clr_mark;              ///< Mark icon color
+        bool smooth;                  ///< Smooth scrolling mode
+
+        bool operator==(const FrameState& other) const = default;
+    };
+
     /**
-     * Draw thumbnail.
+     * Get current state of the tile.
      * @param tlay thumbnail layout description
+     * @param wnd window size
+     * @return tile state
+     */
+    [[nodiscard]] TileState get_tile(const Layout::Thumbnail& tlay,
+                                     const Size& wnd) const;
+
+    /**
+     * Get area covered by the tile.
+     * @param tile tile state
+     * @return tile area including border
+     */
+    [[nodiscard]] Rectangle get_tile_area(const TileState& tile) const;
+
+    /**
+     * Get areas of the window to redraw.
+     * @param tiles current state of the tiles
+     * @param wnd window size
+     * @return array of areas to redraw
+     */
+    [[nodiscard]] std::vector<Rectangle>
+    get_damage(const std::vector<TileState>& tiles, const Size& wnd) const;
+
+    /**
+     * Draw thumbnail.
+     * @param tile tile state
      * @param wnd target window
      */
-    void draw(const Layout::Thumbnail& tlay, Pixmap& wnd);
+    void draw(const TileState& tile, Pixmap& wnd);
 
     /**
      * Refresh view: clear and load thumbnails.
@@ -171,21 +268,31 @@ private:
     void refresh();
 
     /**
-     * Rebuild loading queue.
+     * Update loading queue: drop entries that have left the loading window,
+     * add newly exposed ones and start loader workers.
      */
     void requeue_loading();
 
     /**
-     * Remove invisible thumbnails from the cache.
+     * Clear loading queue and wait for loader workers to finish.
+     */
+    void stop_loading();
+
+    /**
+     * Start loader workers up to the current limit.
+     */
+    void start_loaders();
+
+    /**
+     * Get current limit of concurrent loaders.
+     * @return max number of loader workers
      */
-    void clear_invisible();
+    [[nodiscard]] size_t loader_limit() const;
 
     /**
-     * Get thumbnail pixmap for specified image.
-     * @param entry image entry
-     * @return thumbnail pixmap or nullptr if thumbnail not yet loaded
+     * Loader worker: loads queued thumbnails nearest to the selection.
      */
-    const Pixmap* get_thumbnail(const ImageEntryPtr& entry);
+    void loader();
 
     /**
      * Load image thumbnail.
@@ -193,6 +300,22 @@ private:
      */
     void load_thumbnail(const ImageEntryPtr& entry);
 
+    /**
+     * Get path to the thumbnail in persistent storage.
+     * @param entry image entry for thumbnail
+     * @return path to the thumbnail file
+     */
+    [[nodiscard]] std::filesystem::path
+    pstore_file(const ImageEntryPtr& entry) const;
+
+    /**
+     * Check if thumbnail in persistent storage can be used by gallery, the
+     * validation is the same as on loading (stale thumbnails are removed).
+     * @param entry image entry for thumbnail
+     * @return true if thumbnail exists and is up to date
+     */
+    [[nodiscard]] bool pstore_fresh(const ImageEntryPtr& entry) const;
+
     /**
      * Load thumbnail from persistent storage.
      * @param entry image entry for thumbnail
@@ -220,15 +343,33 @@ private:
 
     bool hover_select; ///< Mouse hover selection
 
+    FrameState drawn_frame;             ///< Last drawn frame state
+    std::vector<TileState> drawn_tiles; ///< Last drawn tiles
+    std::vector<Rectangle> drawn_text;  ///< Last drawn text areas
+    size_t drawn_scroll = 0;            ///< Last drawn viewport position
+
     ThreadPool tpool; ///< Loading threads
 
     bool pstore_enable; ///< Use persistent storage for thumbnails
     std::filesystem::path pstore_path; ///< Persistent storage path
 
-    std::unordered_map<ImageEntryPtr, Pixmap> thumbs; ///< Loaded thumbnails
+    ThumbCache thumbs;                   ///< Loaded thumbnails
     std::set<ImageEntryPtr> crld_thumbs; ///< Currently loading thumbnails
 
+    std::map<size_t, ImageEntryPtr> load_queue; ///< Loading queue by index
+    size_t load_center = 0;  ///< Index of entry with the highest priority
+    size_t load_first = 1;   ///< First index of the queued window
+    size_t load_last = 0;    ///< Last index of the queued window
+    size_t load_evicted = 0; ///< Eviction counter of the queued window
+    size_t load_workers = 0; ///< Number of active loader workers
+    size_t load_threads = 0; ///< Max number of loader workers, 0 for auto
+    double load_cpu = 1.0;   ///< Average CPU usage by a single loader
+    size_t load_count = 0;   ///< Total number of loaded thumbnails
+    double load_rate = 0.0;  ///< Loading rate (thumbnails per second)
+    double rate_start = 0.0; ///< Start time of the rate measurement
+    size_t rate_count = 0;   ///< Number of loads in the rate measurement
+
     bool preload;      ///< Enable/disable preloading of invisible thumbnails
-    size_t cache_size; ///< Max number of thumbnails in cache
-    std::mutex mutex;  ///< Sync mutex for thumbnails cache access
+    size_t cache_size; ///< Number of invisible thumbnails to preload
+    std::mutex mutex;  ///< Sync mutex for loading queue access
 };
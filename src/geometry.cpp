@@ -58,6 +58,26 @@ Rectangle Rectangle::intersect(const Rectangle& other) const
              static_cast<size_t>(y2 - y1) };
 }
 
+Rectangle Rectangle::unite(const Rectangle& other) const
+{
+    if (!other) {
+        return *this;
+    }
+    if (!*this) {
+        return other;
+    }
+
+    const ssize_t x1 = std::min(x, other.x);
+    const ssize_t y1 = std::min(y, other.y);
+    const ssize_t x2 = std::max(x + static_cast<ssize_t>(width),
+                                other.x + static_cast<ssize_t>(other.width));
+    const ssize_t y2 = std::max(y + static_cast<ssize_t>(height),
+                                other.y + static_cast<ssize_t>(other.height));
+
+    return { x1, y1, static_cast<size_t>(x2 - x1),
+             static_cast<size_t>(y2 - y1) };
+}
+
 std::tuple<Rectangle, Rectangle, Rectangle, Rectangle>
 Rectangle::cutout(const Rectangle& cut) const
 {
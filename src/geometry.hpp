@@ -49,6 +49,11 @@ struct Size {
      * Scale size.
      */
     Size operator*(double factor) const;
+
+    /**
+     * Compare sizes.
+     */
+    bool operator==(const Size& other) const = default;
 };
 
 /** Rectangle: position and size. */
@@ -100,6 +105,13 @@ struct Rectangle {
      */
     [[nodiscard]] Rectangle intersect(const Rectangle& other) const;
 
+    /**
+     * Get bounding box of two rectangles.
+     * @param other rectangle to unite with, ignored if not valid
+     * @return rectangle containing both rectangles
+     */
+    [[nodiscard]] Rectangle unite(const Rectangle& other) const;
+
     /**
      * Cut out area from rectangle.
      * @param cut rectangle to cut out
@@ -108,6 +120,11 @@ struct Rectangle {
     [[nodiscard]] std::tuple<Rectangle, Rectangle, Rectangle, Rectangle>
     cutout(const Rectangle& cut) const;
 
+    /**
+     * Compare rectangles.
+     */
+    bool operator==(const Rectangle& other) const = default;
+
     // Invalid position
     static constexpr ssize_t npos = std::numeric_limits<ssize_t>::min();
 };
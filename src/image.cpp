@@ -6,6 +6,9 @@
 
 #include "render.hpp"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+
 #include <cassert>
 
 bool ImageEntry::is_special(const std::string& path)
@@ -14,6 +17,40 @@ bool ImageEntry::is_special(const std::string& path)
         path.starts_with(ImageEntry::SRC_EXEC);
 }
 
+void ImageEntry::set_path(const std::filesystem::path& path,
+                          ImageEntryDirPtr parent)
+{
+    if (!parent) {
+        parent = std::make_shared<ImageEntryDir>();
+        parent->path = path.parent_path();
+    }
+
+    // parent path is always a prefix of the full path
+    const std::string& full = path.native();
+    assert(full.starts_with(parent->path.native()));
+
+    dir = std::move(parent);
+    name = full.substr(dir->path.native().size());
+}
+
+void ImageEntry::load_stat()
+{
+    if ((mtime && size) || is_special()) {
+        return;
+    }
+
+    struct statx st;
+    if (statx(AT_FDCWD, path().c_str(), AT_NO_AUTOMOUNT,
+              STATX_MTIME | STATX_SIZE, &st) == 0) {
+        if (st.stx_mask & STATX_MTIME) {
+            mtime = st.stx_mtime.tv_sec;
+        }
+        if (st.stx_mask & STATX_SIZE) {
+            size = st.stx_size;
+        }
+    }
+}
+
 void Image::draw(const size_t frame, Pixmap& target, const double scale,
                  const ssize_t x, const ssize_t y)
 {
@@ -6,6 +6,7 @@
 
 #include "pixmap.hpp"
 
+#include <atomic>
 #include <filesystem>
 #include <limits>
 #include <map>
@@ -13,14 +14,33 @@
 #include <string>
 #include <vector>
 
+/** Group of adjacent entries in the image list. */
+struct ImageEntryGroup {
+    /** Index of the first entry of the group in the list. */
+    std::atomic<size_t> start = 0;
+};
+
+/** Parent directory of image entries, shared by all entries inside it. */
+struct ImageEntryDir {
+    std::filesystem::path path; ///< Path to the directory
+    std::string key;            ///< Sort key of the directory
+    size_t count = 0;           ///< Number of entries in the image list
+};
+
+using ImageEntryDirPtr = std::shared_ptr<ImageEntryDir>;
+
 /** Image entry. */
 struct ImageEntry {
-    size_t index = std::numeric_limits<size_t>::max(); ///< Index in image list
-    std::filesystem::path path; ///< Path to the image file
-    std::time_t mtime = 0;      ///< File modification time
-    size_t size = 0;            ///< Size of the image file
-    bool mark = false;          ///< Marked image flag
-    bool removed = false;       ///< State, true if removed from image list
+    /** Group in the image list. */
+    std::atomic<const ImageEntryGroup*> group = nullptr;
+    /** Index of the entry in the group. */
+    std::atomic<size_t> offset = std::numeric_limits<size_t>::max();
+    ImageEntryDirPtr dir; ///< Parent directory
+    std::string name;     ///< Rest of the path after the parent directory
+    std::time_t mtime = 0; ///< File modification time
+    size_t size = 0;       ///< Size of the image file
+    bool mark = false;     ///< Marked image flag
+    bool removed = false;  ///< State, true if removed from image list
 
     // File name used for image, that is read from stdin through pipe
     static constexpr const char* SRC_STDIN = "stdin://";
@@ -31,7 +51,56 @@ struct ImageEntry {
      * Check if entry has a special source.
      * @return true if path starts with stdin:// or exec://
      */
-    [[nodiscard]] bool is_special() const { return is_special(path); }
+    [[nodiscard]] bool is_special() const { return is_special(path()); }
+
+    /**
+     * Get path to the image file.
+     * @return path to the image file or special source
+     */
+    [[nodiscard]] std::filesystem::path path() const
+    {
+        return dir ? dir->path.native() + name : name;
+    }
+
+    /**
+     * Set path to the image file.
+     * @param path path to the image file or special source
+     * @param parent parent directory of the path, nullptr to create new one
+     */
+    void set_path(const std::filesystem::path& path,
+                  ImageEntryDirPtr parent = nullptr);
+
+    /**
+     * Get index of the entry in the image list.
+     * The index is computed from the group position, so the list doesn't need
+     * to update every entry on insertion or removal.
+     * Other threads can read the index while the list is modified under its
+     * lock, in this case the index may be outdated, but it is always valid.
+     * @return index of the entry, the last known index for removed entries
+     */
+    [[nodiscard]] size_t index() const
+    {
+        const ImageEntryGroup* grp = group.load(std::memory_order_acquire);
+        const size_t idx = offset.load(std::memory_order_relaxed);
+        return grp ? grp->start.load(std::memory_order_relaxed) + idx : idx;
+    }
+
+    /**
+     * Set position of the entry in the image list.
+     * @param grp group of the entry, nullptr if entry is not in a group
+     * @param idx index of the entry in the group
+     */
+    void set_position(const ImageEntryGroup* grp, const size_t idx)
+    {
+        offset.store(idx, std::memory_order_relaxed);
+        group.store(grp, std::memory_order_release);
+    }
+
+    /**
+     * Set fixed index of the entry that doesn't belong to the list.
+     * @param idx index to set
+     */
+    void set_index(const size_t idx) { set_position(nullptr, idx); }
 
     /**
      * Check if path is a special source.
@@ -39,6 +108,13 @@ struct ImageEntry {
      * @return true if path starts with stdin:// or exec://
      */
     static bool is_special(const std::string& path);
+
+    /**
+     * Read file modification time and size if they are not known yet.
+     * The image list skips file stat while scanning directories if the
+     * attributes are not needed for sorting, so they are loaded on demand.
+     */
+    void load_stat();
 };
 
 using ImageEntryPtr = std::shared_ptr<ImageEntry>;
@@ -43,13 +43,13 @@ struct DataBuffer : public ImageFormat::Data {
     {
         bool rc;
 
-        const std::string full_path = entry->path.string();
+        const std::string full_path = entry->path().string();
         if (full_path.starts_with(ImageEntry::SRC_STDIN)) {
             rc = read_stream(STDIN_FILENO);
         } else if (full_path.starts_with(ImageEntry::SRC_EXEC)) {
             rc = read_stdout(full_path.substr(strlen(ImageEntry::SRC_EXEC)));
         } else {
-            rc = read_file(entry->path);
+            rc = read_file(entry->path());
         }
 
         if (rc && size == 0) {
@@ -399,19 +399,19 @@ ImagePtr FormatFactory::load(const ImageEntryPtr& entry) const
 
     ImagePtr image = decode(data);
     if (!image) {
-        Log::verbose("Unsupported image format in {}", entry->path.string());
+        Log::verbose("Unsupported image format in {}", entry->path().string());
     } else {
         if (Log::verbose_enable()) {
             Log::verbose("Image {} loaded in {:.6f} sec",
-                         entry->path.filename().string(), timer.time());
+                         entry->path().filename().string(), timer.time());
         }
 
-        const std::string path = entry->path.string();
-        if (path.starts_with(ImageEntry::SRC_STDIN) ||
-            path.starts_with(ImageEntry::SRC_EXEC)) {
+        // attributes of list files are sorting keys, they are updated by the
+        // image list on the main thread only
+        if (entry->is_special()) {
             entry->mtime = time(nullptr);
+            entry->size = data.size;
         }
-        entry->size = data.size;
         image->entry = entry;
     }
 
@@ -7,129 +7,173 @@
 #include "defaults.hpp"
 #include "fsmonitor.hpp"
 #include "log.hpp"
+#include "threadpool.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <locale>
 #include <mutex>
 #include <random>
 #include <string>
 
 namespace {
 
+// Directory scanning threads, the work is I/O bound
+constexpr size_t SCAN_THREADS_PER_CORE = 2;
+constexpr size_t SCAN_THREADS_MAX = 16;
+
+// Number of entries in a group of the list, a group is split when it grows
+// twice as large
+constexpr size_t GROUP_SIZE = 256;
+
+// Changes smaller than 1/N of the list are applied incrementally, larger ones
+// rebuild the whole list
+constexpr size_t INCREMENTAL_RATIO = 8;
+
 /**
- * Comparison of two localized strings.
- * @param l,r strings to compare
- * @param numeric flag to use numeric compare
- * @return compare result
+ * Move start position of the group.
+ * The list is modified by a single thread under the lock, other threads only
+ * read the position, so atomic read-modify-write is not required.
+ * @param group group to move
+ * @param delta offset to add to the start position
+ */
+void shift(ImageEntryGroup& group, const ssize_t delta)
+{
+    group.start.store(group.start.load(std::memory_order_relaxed) + delta,
+                      std::memory_order_relaxed);
+}
+
+/**
+ * Convert ASCII string to lower case.
+ * @param str source string
+ * @return string in lower case
+ */
+std::string to_lower(std::string str)
+{
+    std::ranges::transform(str, str.begin(), [](const unsigned char c) {
+        return std::tolower(c);
+    });
+    return str;
+}
+
+/**
+ * Make sort key for the string: byte comparison of keys gives the same result
+ * as localized comparison of the source strings.
+ * @param str source string
+ * @param numeric flag to compare digit runs as numbers
+ * @return sort key
  */
-int compare_strings(const std::string& l, const std::string& r,
-                    const bool numeric)
+std::string make_key(const std::string& str, const bool numeric)
 {
     static const std::locale loc("");
     static const std::collate<char>& coll =
         std::use_facet<std::collate<char>>(loc);
 
-    int cmp = 0;
-
     if (!numeric) {
-        cmp = coll.compare(l.data(), l.data() + l.length(), r.data(),
-                           r.data() + r.length());
-    } else {
-        const std::string digits = "0123456789";
-        std::string ls(l);
-        std::string rs(r);
-        while (true) {
-            const size_t ldstart = ls.find_first_of(digits);
-            const size_t rdstart = rs.find_first_of(digits);
-            if (ldstart == std::string::npos || rdstart != ldstart) {
-                cmp = coll.compare(ls.data(), ls.data() + ls.length(),
-                                   rs.data(), rs.data() + rs.length());
-                break;
-            }
-            cmp = coll.compare(ls.data(), ls.data() + ldstart, rs.data(),
-                               rs.data() + rdstart);
-            if (cmp) {
-                break;
-            }
-
-            ls.erase(0, ldstart);
-            rs.erase(0, rdstart);
+        return coll.transform(str.data(), str.data() + str.length());
+    }
 
-            try {
-                const size_t lnum = std::stoull(ls);
-                const size_t rnum = std::stoull(rs);
-                if (lnum != rnum) {
-                    cmp = lnum < rnum ? -1 : 1;
-                    break;
-                }
-            } catch (const std::out_of_range&) {
-                cmp = coll.compare(l.data(), l.data() + l.length(), r.data(),
-                                   r.data() + r.length());
-                break;
+    // split into text and number tokens, numbers are stored without leading
+    // zeros and prefixed with their length, so that longer is greater
+    constexpr char TOKEN_NUMBER = 1;
+    constexpr char TOKEN_TEXT = 2;
+    constexpr const char* DIGITS = "0123456789";
+
+    std::string key;
+    size_t pos = 0;
+    while (pos < str.length()) {
+        size_t end = str.find_first_of(DIGITS, pos);
+        if (end != pos) {
+            if (end == std::string::npos) {
+                end = str.length();
             }
-
-            const size_t ldend = ls.find_first_not_of(digits);
-            const size_t rdend = rs.find_first_not_of(digits);
-            ls.erase(0, ldend);
-            rs.erase(0, rdend);
+            key += TOKEN_TEXT;
+            key += coll.transform(str.data() + pos, str.data() + end);
+            key += '\0'; // transformed text never contains null
+        } else {
+            end = str.find_first_not_of(DIGITS, pos);
+            if (end == std::string::npos) {
+                end = str.length();
+            }
+            const size_t start = std::min(str.find_first_not_of('0', pos), end);
+            const size_t len = std::min(end - start, size_t { UINT8_MAX });
+            key += TOKEN_NUMBER;
+            key += static_cast<char>(len);
+            key.append(str, start, len);
         }
+        pos = end;
     }
 
-    return cmp;
+    return key;
+}
+
+/**
+ * Make sort key for the directory path: each component is terminated by null,
+ * so the parent directory is less than any of its children.
+ * @param path path to the directory
+ * @param numeric flag to compare digit runs as numbers
+ * @return sort key
+ */
+std::string make_dir_key(const std::filesystem::path& path, const bool numeric)
+{
+    std::string key;
+    for (const std::filesystem::path& it : path) {
+        key += make_key(it.string(), numeric);
+        key += '\0';
+    }
+    return key;
 }
 
 /**
- * Comparison of two paths.
- * @param l,r paths to compare
- * @param numeric flag to use numeric compare
+ * Comparison of two image entries by precomputed keys.
+ * @param l,r image entries to compare
+ * @param lkey,rkey file name sort keys of the entries
  * @return compare result
  */
-int compare_paths(const std::filesystem::path& l,
-                  const std::filesystem::path& r, const bool numeric)
-{
-    // compare parents
-    const std::filesystem::path l_parent = l.parent_path();
-    const std::filesystem::path r_parent = r.parent_path();
-    auto it_l = l_parent.begin();
-    auto it_r = r_parent.begin();
-    while (it_l != l_parent.end() && it_r != r_parent.end()) {
-        const int cmp = compare_strings(*it_l, *it_r, numeric);
+int compare_keys(const ImageEntry& l, const std::string& lkey,
+                 const ImageEntry& r, const std::string& rkey)
+{
+    assert(l.dir && r.dir);
+    if (l.dir != r.dir) { // interned: same pointer for same dir
+        const int cmp = l.dir->key.compare(r.dir->key);
         if (cmp) {
             return cmp;
         }
-        ++it_l;
-        ++it_r;
-    }
-    if (it_l == l_parent.end() && it_r != r_parent.end()) {
-        return -1;
     }
-    if (it_l != l_parent.end() && it_r == r_parent.end()) {
-        return 1;
-    }
-
-    // compare names
-    return compare_strings(l.filename(), r.filename(), numeric);
+    return lkey.compare(rkey);
 }
 
 /**
  * Comparison of two image entries.
  * @param l,r image entries to compare
+ * @param lkey,rkey file name sort keys of the entries
  * @param order criterion for comparison
  * @return true if l < r
  */
-bool compare_entries(const ImageEntry& l, const ImageEntry& r,
+bool compare_entries(const ImageEntry& l, const std::string& lkey,
+                     const ImageEntry& r, const std::string& rkey,
                      const ImageList::Order order)
 {
     switch (order) {
         case ImageList::Order::Alpha:
-            return compare_paths(l.path, r.path, false) < 0;
         case ImageList::Order::Numeric:
-            return compare_paths(l.path, r.path, true) < 0;
+            return compare_keys(l, lkey, r, rkey) < 0;
         case ImageList::Order::Mtime:
-            return l.mtime == r.mtime ? compare_paths(l.path, r.path, false) < 0
+            return l.mtime == r.mtime ? compare_keys(l, lkey, r, rkey) < 0
                                       : l.mtime < r.mtime;
         case ImageList::Order::Size:
-            return l.size == r.size ? compare_paths(l.path, r.path, false) < 0
+            return l.size == r.size ? compare_keys(l, lkey, r, rkey) < 0
                                     : l.size < r.size;
         case ImageList::Order::None:
         case ImageList::Order::Random:
@@ -139,6 +183,258 @@ bool compare_entries(const ImageEntry& l, const ImageEntry& r,
     return false;
 }
 
+/**
+ * Get file attributes required for sorting.
+ * @param order image list order
+ * @return statx mask
+ */
+unsigned int stat_mask(const ImageList::Order order)
+{
+    switch (order) {
+        case ImageList::Order::Mtime:
+            return STATX_MTIME;
+        case ImageList::Order::Size:
+            return STATX_SIZE;
+        case ImageList::Order::None:
+        case ImageList::Order::Alpha:
+        case ImageList::Order::Numeric:
+        case ImageList::Order::Random:
+            break;
+    }
+    return 0;
+}
+
+/**
+ * Directory reader: provides file names and types with a single
+ * getdents64 syscall per batch of entries, without stat for each file.
+ */
+class DirReader {
+public:
+    /**
+     * Constructor.
+     * @param path path to the directory
+     */
+    explicit DirReader(const std::filesystem::path& path)
+        : fd(open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+        , buffer(BUFFER_SIZE)
+    {
+    }
+
+    ~DirReader()
+    {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    /**
+     * Get directory file descriptor.
+     * @return file descriptor, -1 if directory can not be opened
+     */
+    [[nodiscard]] int handle() const { return fd; }
+
+    /**
+     * Get next directory entry.
+     * @return pointer to the entry or nullptr at the end of the directory
+     */
+    const dirent64* next()
+    {
+        while (fd != -1) {
+            if (offset >= length) {
+                const ssize_t rc =
+                    getdents64(fd, buffer.data(), buffer.size());
+                if (rc <= 0) {
+                    break;
+                }
+                length = rc;
+                offset = 0;
+            }
+            const dirent64* entry =
+                reinterpret_cast<const dirent64*>(buffer.data() + offset);
+            offset += entry->d_reclen;
+            if (strcmp(entry->d_name, ".") != 0 &&
+                strcmp(entry->d_name, "..") != 0) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    int fd;                   ///< Directory file descriptor
+    std::vector<char> buffer; ///< Buffer for getdents64
+    size_t offset = 0;        ///< Current position in the buffer
+    size_t length = 0;        ///< Size of data in the buffer
+};
+
+/** Result of scanning single directory. */
+struct ScanResult {
+    std::vector<ImageList::File> files;      ///< Regular files
+    std::vector<std::filesystem::path> dirs; ///< Nested directories
+    std::vector<ImageList::File> filtered;   ///< Files filtered out
+};
+
+/**
+ * Create file description from its attributes.
+ * @param path path to the file
+ * @param st file attributes
+ * @return file description
+ */
+ImageList::File make_file(const std::filesystem::path& path,
+                          const struct statx& st)
+{
+    ImageList::File file { .path = path };
+    if (st.stx_mask & STATX_MTIME) {
+        file.mtime = st.stx_mtime.tv_sec;
+    }
+    if (st.stx_mask & STATX_SIZE) {
+        file.size = st.stx_size;
+    }
+    return file;
+}
+
+/**
+ * Get directory listing from the cache.
+ * @param path path to the directory
+ * @param stamp current modification time of the directory
+ * @param mask statx mask with file attributes required for sorting
+ * @param exts extension filter, nullptr to allow all files
+ * @param cache directory listing cache
+ * @param result output files and nested directories
+ * @return false if directory is not cached or required attributes are missing
+ */
+bool read_cached(const std::filesystem::path& path,
+                 const DirCache::Stamp& stamp, const unsigned int mask,
+                 const ImageList::Extensions* exts, const DirCache& cache,
+                 ScanResult& result)
+{
+    DirCache::Listing listing;
+    if (!cache.get(path, stamp, listing) || (listing.attrs & mask) != mask) {
+        return false;
+    }
+
+    result.files.reserve(listing.files.size());
+    for (const DirCache::File& it : listing.files) {
+        ImageList::File file {
+            .path = path / it.name, .mtime = it.mtime, .size = it.size
+        };
+        if (!exts || ImageList::allowed(*exts, file.path)) {
+            result.files.emplace_back(std::move(file));
+        }
+    }
+    result.dirs.reserve(listing.dirs.size());
+    for (const std::string& it : listing.dirs) {
+        result.dirs.emplace_back(path / it);
+    }
+
+    return true;
+}
+
+/**
+ * Put directory listing to the cache.
+ * Filtered out files are stored without attributes, so the cache doesn't
+ * depend on the filter; the list loads missing attributes on sorting.
+ * @param path path to the directory
+ * @param stamp modification time of the directory
+ * @param mask statx mask with file attributes loaded while reading
+ * @param result files and nested directories
+ * @param cache directory listing cache
+ */
+void write_cached(const std::filesystem::path& path,
+                  const DirCache::Stamp& stamp, const unsigned int mask,
+                  const ScanResult& result, DirCache& cache)
+{
+    DirCache::Listing listing;
+    listing.attrs = mask;
+
+    listing.files.reserve(result.files.size() + result.filtered.size());
+    for (const auto& files : { &result.files, &result.filtered }) {
+        for (const ImageList::File& it : *files) {
+            listing.files.push_back({ .name = it.path.filename(),
+                                      .mtime = it.mtime,
+                                      .size = it.size });
+        }
+    }
+    listing.dirs.reserve(result.dirs.size());
+    for (const std::filesystem::path& it : result.dirs) {
+        listing.dirs.emplace_back(it.filename());
+    }
+
+    cache.put(path, stamp, std::move(listing));
+}
+
+/**
+ * Read single directory (thread safe).
+ * @param path path to the directory
+ * @param mask statx mask with file attributes required for sorting
+ * @param exts extension filter, nullptr to allow all files
+ * @param cache directory listing cache, nullptr if not used
+ * @return found files and nested directories
+ */
+ScanResult read_dir(const std::filesystem::path& path, const unsigned int mask,
+                    const ImageList::Extensions* exts, DirCache* cache)
+{
+    ScanResult result;
+
+    // the directory is not changed while its modification time is the same
+    DirCache::Stamp stamp;
+    if (cache) {
+        struct statx st;
+        if (statx(AT_FDCWD, path.c_str(), AT_NO_AUTOMOUNT, STATX_MTIME,
+                  &st) != 0 ||
+            !(st.stx_mask & STATX_MTIME)) {
+            cache = nullptr;
+        } else {
+            stamp.sec = st.stx_mtime.tv_sec;
+            stamp.nsec = st.stx_mtime.tv_nsec;
+            if (read_cached(path, stamp, mask, exts, *cache, result)) {
+                return result;
+            }
+        }
+    }
+
+    // file type is provided by getdents64 on most file systems, so stat
+    // is required only for symlinks and for sorting attributes, filtered out
+    // files are never stat'ed for sorting
+    DirReader dir(path);
+    while (const dirent64* it = dir.next()) {
+        std::filesystem::path file = path / it->d_name;
+        const bool allowed = !exts || ImageList::allowed(*exts, file);
+        const unsigned int attrs = allowed ? mask : 0;
+        uint8_t type = it->d_type;
+        struct statx st;
+        st.stx_mask = 0;
+        if (type == DT_UNKNOWN || type == DT_LNK || (type == DT_REG && attrs)) {
+            if (statx(dir.handle(), it->d_name, AT_NO_AUTOMOUNT,
+                      STATX_TYPE | attrs, &st) != 0) {
+                continue;
+            }
+            type = IFTODT(st.stx_mode);
+        }
+
+        if (type == DT_DIR) {
+            result.dirs.emplace_back(std::move(file));
+        } else if (type == DT_REG) {
+            if (allowed) {
+                result.files.emplace_back(make_file(file, st));
+            } else if (cache) {
+                result.filtered.push_back({ .path = std::move(file) });
+            }
+        } else {
+            Log::warning("File {} is not a regular, skipped",
+                         (path / it->d_name).string());
+        }
+    }
+
+    if (cache) {
+        write_cached(path, stamp, mask, result, *cache);
+    }
+
+    return result;
+}
+
 } // anonymous namespace
 
 ImageList& ImageList::self()
@@ -153,6 +449,8 @@ ImageList::ImageList()
     , recursive(Defaults::imglist::recursive)
     , adjacent(Defaults::imglist::adjacent)
     , fsmon(Defaults::imglist::fsmon)
+    , cache(Defaults::imglist::cache)
+    , cache_path(Defaults::imglist::cache_path())
 {
 }
 
@@ -160,18 +458,62 @@ ImageList::EntriesArray
 ImageList::add(const std::vector<std::filesystem::path>& sources)
 {
     EntriesArray added;
-    const std::scoped_lock lock(mutex);
-    for (const auto& path : sources) {
-        EntriesArray entries = add_any(path);
+
+    scan(sources, get_scan_options(), [this, &added](Batch&& batch) {
+        const std::scoped_lock lock(mutex);
+        EntriesArray entries = add_batch(batch);
+        sort(entries);
         added.reserve(added.size() + entries.size());
         added.insert(added.end(), entries.begin(), entries.end());
-    }
+        return true;
+    });
 
-    sort();
+    return added;
+}
+
+ImageList::EntriesArray ImageList::add(const Batch& batch)
+{
+    const std::scoped_lock lock(mutex);
+
+    // scanned files are in directory order, return them in the list order
+    EntriesArray added = add_batch(batch);
+    std::ranges::sort(added, {}, [](const ImageEntryPtr& entry) {
+        return entry->index();
+    });
 
     return added;
 }
 
+ImageList::ScanOptions ImageList::get_scan_options() const
+{
+    return { .mask = stat_mask(order),
+             .recursive = recursive,
+             .adjacent = adjacent,
+             .fsmon = fsmon,
+             .cache = cache ? cache_path : std::filesystem::path(),
+             .exts = get_extensions() };
+}
+
+void ImageList::scan(const std::vector<std::filesystem::path>& sources,
+                     const ScanOptions& options,
+                     const BatchHandler& handler) const
+{
+    if (!options.cache.empty()) {
+        dircache.open(options.cache);
+    }
+
+    for (const auto& path : sources) {
+        if (!scan_any(path, options, handler)) {
+            break;
+        }
+    }
+}
+
+void ImageList::save_cache() const
+{
+    dircache.save();
+}
+
 ImageList::EntriesArray
 ImageList::remove(const std::vector<std::filesystem::path>& sources)
 {
@@ -181,7 +523,7 @@ ImageList::remove(const std::vector<std::filesystem::path>& sources)
 
     const std::scoped_lock lock(mutex);
 
-    if (entries_arr.empty()) {
+    if (total == 0) {
         return {};
     }
 
@@ -204,19 +546,16 @@ ImageList::remove(const std::vector<std::filesystem::path>& sources)
             // remove all child entries
             for (const ImageEntryPtr& entry : get_child(abs_path)) {
                 entry->removed = true;
-                entries_map.erase(entry->path);
-                entries_arr[entry->index] = nullptr;
+                entries_set.erase(entry);
                 removed.emplace_back(entry);
             }
             FsMonitor::self().remove(abs_path);
         } else {
             // remove single entry
-            auto it = entries_map.find(abs_path);
-            if (it != entries_map.end()) {
-                const ImageEntryPtr entry = it->second;
+            const ImageEntryPtr entry = find_entry(abs_path);
+            if (entry) {
                 entry->removed = true;
-                entries_map.erase(it);
-                entries_arr[entry->index] = nullptr;
+                entries_set.erase(entry);
                 removed.emplace_back(entry);
             }
         }
@@ -225,12 +564,9 @@ ImageList::remove(const std::vector<std::filesystem::path>& sources)
     if (!removed.empty()) {
         FsMonitor& fsmon = FsMonitor::self();
         for (const ImageEntryPtr& entry : removed) {
-            fsmon.remove(entry->path);
+            fsmon.remove(entry->path());
         }
-        std::erase_if(entries_arr, [](const ImageEntryPtr& entry) {
-            return !entry;
-        });
-        reindex();
+        erase(removed);
     }
 
     return removed;
@@ -242,21 +578,61 @@ void ImageList::remove(const ImageEntryPtr& entry)
 
     const std::scoped_lock lock(mutex);
 
-    entries_map.erase(entry->path);
-    entries_arr.erase(entries_arr.begin() + entry->index);
-    reindex(entry->index);
-
     entry->removed = true;
-    FsMonitor::self().remove(entry->path);
+    entries_set.erase(entry);
+    erase({ entry });
+
+    FsMonitor::self().remove(entry->path());
+}
+
+void ImageList::refresh(const EntriesArray& entries)
+{
+    const std::scoped_lock lock(mutex);
+
+    EntriesArray moved;
+    for (const ImageEntryPtr& entry : entries) {
+        if (entry->removed || entry->is_special()) {
+            continue;
+        }
+        const std::time_t mtime = entry->mtime;
+        const size_t size = entry->size;
+        entry->mtime = 0;
+        entry->size = 0;
+        entry->load_stat();
+        if ((order == Order::Mtime && entry->mtime != mtime) ||
+            (order == Order::Size && entry->size != size)) {
+            moved.push_back(entry);
+        }
+    }
+    if (moved.empty()) {
+        return;
+    }
+
+    // from the end, so indices of the rest are not changed
+    std::ranges::sort(moved, std::greater {}, [](const ImageEntryPtr& entry) {
+        return entry->index();
+    });
+    for (const ImageEntryPtr& entry : moved) {
+        erase_at(entry->index());
+        --entry->dir->count;
+    }
+    insert(moved);
 }
 
 ImageList::EntriesArray ImageList::clear()
 {
     const std::scoped_lock lock(mutex);
 
-    EntriesArray removed = entries_arr;
-    entries_map.clear();
-    entries_arr.clear();
+    EntriesArray removed = flatten();
+    rebuild({});
+    for (size_t i = 0; i < removed.size(); ++i) {
+        removed[i]->set_index(i);
+    }
+    entries_set.clear();
+    for (auto& [_, dir] : dirs) {
+        dir->count = 0;
+    }
+    dirs.clear();
 
     FsMonitor::self().clear();
 
@@ -266,14 +642,21 @@ ImageList::EntriesArray ImageList::clear()
 size_t ImageList::size()
 {
     const std::shared_lock lock(mutex);
-    return entries_arr.size();
+    return total;
 }
 
 void ImageList::set_order(const Order new_order)
 {
     if (order != new_order || new_order == Order::Random) {
-        order = new_order;
         const std::scoped_lock lock(mutex);
+        if ((order == Order::Numeric) != (new_order == Order::Numeric)) {
+            // sort keys depend on the numeric flag
+            const bool numeric = (new_order == Order::Numeric);
+            for (auto& [path, dir] : dirs) {
+                dir->key = make_dir_key(path, numeric);
+            }
+        }
+        order = new_order;
         sort();
     }
 }
@@ -303,42 +686,41 @@ ImageEntryPtr ImageList::find(const std::filesystem::path& path)
 
     const std::shared_lock lock(mutex);
 
-    auto it = entries_map.find(search);
-    return it == entries_map.end() ? nullptr : it->second;
+    return find_entry(search);
 }
 
 ImageList::EntriesArray ImageList::get_all()
 {
     const std::shared_lock lock(mutex);
-    return entries_arr;
+    return flatten();
 }
 
 ImageEntryPtr ImageList::get(const ImageEntryPtr& from, const Dir dir)
 {
     const std::shared_lock lock(mutex);
 
-    if (entries_arr.empty()) {
+    if (total == 0) {
         return nullptr;
     }
     if (dir == Dir::First) {
-        return entries_arr.front();
+        return groups.front()->entries.front();
     }
     if (dir == Dir::Last) {
-        return entries_arr.back();
+        return groups.back()->entries.back();
     }
 
     assert(from);
 
     // handle removed entry: return nearest entry
     if (from->removed) {
-        size_t index = from->index;
+        size_t index = from->index();
         if (index &&
             (dir == ImageList::Dir::Prev ||
              dir == ImageList::Dir::PrevParent)) {
             --index;
         }
-        index = std::min(index, entries_arr.size() - 1);
-        return entries_arr[index];
+        index = std::min(index, total - 1);
+        return at(index);
     }
 
     ImageEntryPtr entry = nullptr;
@@ -349,13 +731,13 @@ ImageEntryPtr ImageList::get(const ImageEntryPtr& from, const Dir dir)
             assert(false && "should be already handled");
             break;
         case Dir::Next:
-            if (from->index + 1 < entries_arr.size()) {
-                entry = entries_arr[from->index + 1];
+            if (from->index() + 1 < total) {
+                entry = at(from->index() + 1);
             }
             break;
         case Dir::Prev:
-            if (entries_arr.size() > 1 && from->index > 0) {
-                entry = entries_arr[from->index - 1];
+            if (total > 1 && from->index() > 0) {
+                entry = at(from->index() - 1);
             }
             break;
         case Dir::NextParent:
@@ -365,10 +747,10 @@ ImageEntryPtr ImageList::get(const ImageEntryPtr& from, const Dir dir)
             entry = get_diffparent(from, false);
             break;
         case Dir::Random:
-            if (entries_arr.size() > 1) {
+            if (total > 1) {
                 entry = from;
                 while (entry == from) {
-                    entry = entries_arr[rand() % entries_arr.size()];
+                    entry = at(rand() % total);
                 }
             }
             break;
@@ -383,13 +765,36 @@ ImageEntryPtr ImageList::get(const ImageEntryPtr& from, const ssize_t distance)
 
     assert(from && !from->removed);
 
-    const size_t index = from->index;
-    if (index + distance >= entries_arr.size() ||
+    const size_t index = from->index();
+    if (index + distance >= total ||
         static_cast<ssize_t>(index) + distance < 0) {
         return nullptr;
     }
 
-    return entries_arr[index + distance];
+    return at(index + distance);
+}
+
+ImageList::EntriesArray ImageList::get_range(const size_t first,
+                                             const size_t last)
+{
+    const std::shared_lock lock(mutex);
+
+    if (first > last || first >= total) {
+        return {};
+    }
+
+    const size_t count = std::min(last + 1, total) - first;
+    EntriesArray range;
+    range.reserve(count);
+    for (size_t i = group_of(first); range.size() < count; ++i) {
+        const Group& grp = *groups[i];
+        const size_t from = first + range.size() - grp.start;
+        const size_t to =
+            std::min(grp.entries.size(), from + count - range.size());
+        range.insert(range.end(), grp.entries.begin() + from,
+                     grp.entries.begin() + to);
+    }
+    return range;
 }
 
 ssize_t ImageList::distance(const ImageEntryPtr& from, const ImageEntryPtr& to)
@@ -397,11 +802,25 @@ ssize_t ImageList::distance(const ImageEntryPtr& from, const ImageEntryPtr& to)
     const std::shared_lock lock(mutex);
 
     assert(from && !from->removed);
-    assert(from->index < entries_arr.size());
+    assert(from->index() < total);
     assert(to && !to->removed);
-    assert(to->index < entries_arr.size());
+    assert(to->index() < total);
 
-    return static_cast<ssize_t>(to->index) - static_cast<ssize_t>(from->index);
+    return static_cast<ssize_t>(to->index()) -
+        static_cast<ssize_t>(from->index());
+}
+
+std::vector<std::pair<std::filesystem::path, size_t>> ImageList::get_dirs()
+{
+    const std::shared_lock lock(mutex);
+
+    std::vector<std::pair<std::filesystem::path, size_t>> result;
+    for (const auto& [path, dir] : dirs) {
+        if (dir->count) {
+            result.emplace_back(path, dir->count);
+        }
+    }
+    return result;
 }
 
 ImageList::EntriesArray
@@ -411,10 +830,24 @@ ImageList::get_child(const std::filesystem::path& path) const
 
     EntriesArray child;
 
-    for (const ImageEntryPtr& entry : entries_arr) {
-        const std::filesystem::path rel = entry->path.lexically_relative(path);
-        if (!rel.empty() && !rel.string().starts_with("..")) {
-            child.push_back(entry);
+    // entries of the same directory are usually adjacent
+    const ImageEntryDir* last_dir = nullptr;
+    bool is_child = false;
+
+    for (const GroupPtr& grp : groups) {
+        for (const ImageEntryPtr& entry : grp->entries) {
+            if (entry->removed) {
+                continue;
+            }
+            if (entry->dir.get() != last_dir) {
+                last_dir = entry->dir.get();
+                const std::filesystem::path rel =
+                    last_dir->path.lexically_relative(path);
+                is_child = !rel.empty() && !rel.string().starts_with("..");
+            }
+            if (is_child) {
+                child.push_back(entry);
+            }
         }
     }
 
@@ -426,120 +859,201 @@ ImageEntryPtr ImageList::get_diffparent(const ImageEntryPtr& from,
 {
     assert(from && !from->removed);
 
-    const std::filesystem::path from_parent = from->path.parent_path();
-
-    const ssize_t size = static_cast<ssize_t>(entries_arr.size());
-    const ssize_t direction_sign = forward ? 1 : -1;
-    ssize_t index = static_cast<ssize_t>(from->index) + direction_sign;
-
-    while (index >= 0 && index < size) {
-        ImageEntryPtr entry = entries_arr[index];
-        if (from_parent != entry->path.parent_path()) {
-            return entry;
-        }
-        index += direction_sign;
+    auto it = runs.upper_bound(from->index());
+    if (forward) {
+        // head of the next run
+        return it == runs.end() ? nullptr : at((*it)->index());
     }
 
-    return nullptr;
+    // last entry before the head of the current run
+    assert(it != runs.begin());
+    const size_t head = (*std::prev(it))->index();
+    return head ? at(head - 1) : nullptr;
 }
 
-ImageList::EntriesArray ImageList::add_any(const std::filesystem::path& path)
+bool ImageList::scan_any(const std::filesystem::path& path,
+                         const ScanOptions& options,
+                         const BatchHandler& handler) const
 {
     if (ImageEntry::is_special(path)) {
-        const ImageEntryPtr entry = add_entry(path);
-        if (entry) {
-            return { entry };
-        }
-        return {};
+        Batch batch;
+        batch.files.push_back({ .path = path });
+        return handler(std::move(batch));
     }
 
     std::filesystem::path abs_path;
     try {
         abs_path = std::filesystem::absolute(path).lexically_normal();
-        if (!std::filesystem::exists(abs_path)) {
-            Log::warning("File {} not found, skipped", abs_path.string());
-            return {};
-        }
     } catch (const std::filesystem::filesystem_error&) {
         Log::warning("Invalid path {}, skipped", path.string());
-        return {};
+        return true;
     }
 
-    EntriesArray added;
-    if (!std::filesystem::is_directory(abs_path)) {
-        const ImageEntryPtr entry = add_file(abs_path);
-        if (entry) {
-            added.emplace_back(entry);
-        }
+    struct statx st;
+    if (statx(AT_FDCWD, abs_path.c_str(), AT_NO_AUTOMOUNT,
+              STATX_TYPE | options.mask, &st) != 0) {
+        Log::warning("File {} not found, skipped", abs_path.string());
+        return true;
+    }
 
-        if (!adjacent) {
-            if (fsmon) {
-                FsMonitor::self().add(abs_path);
-            }
-            return added;
+    if (!S_ISDIR(st.stx_mode)) {
+        Batch batch;
+        if (!S_ISREG(st.stx_mode)) {
+            Log::warning("File {} is not a regular, skipped",
+                         abs_path.string());
+        } else if (options.exts && !allowed(*options.exts, abs_path)) {
+            Log::verbose("File {} is filtered out by extension",
+                         abs_path.string());
+        } else {
+            batch.files.emplace_back(make_file(abs_path, st));
+        }
+        if (!options.adjacent && options.fsmon) {
+            batch.watch.emplace_back(abs_path);
+        }
+        if (!handler(std::move(batch))) {
+            return false;
+        }
+        if (!options.adjacent) {
+            return true;
         }
         abs_path = abs_path.parent_path();
     }
 
-    EntriesArray dir_entries = add_dir(abs_path);
-    if (!dir_entries.empty()) {
-        sort(dir_entries);
-        added.reserve(added.size() + dir_entries.size());
-        added.insert(added.end(), dir_entries.begin(), dir_entries.end());
+    return scan_dir(abs_path, options, handler);
+}
+
+bool ImageList::scan_dir(const std::filesystem::path& path,
+                         const ScanOptions& options,
+                         const BatchHandler& handler) const
+{
+    const unsigned int mask = options.mask;
+    DirCache* cached = options.cache.empty() ? nullptr : &dircache;
+
+    ScanResult top = read_dir(path, mask, options.exts.get(), cached);
+    Batch top_batch;
+    top_batch.files = std::move(top.files);
+    if (options.fsmon) {
+        top_batch.watch.emplace_back(path);
+    }
+    if (!handler(std::move(top_batch))) {
+        return false;
     }
 
-    return added;
+    // nested directories are scanned in parallel to hide I/O latency
+    std::atomic<bool> proceed = true;
+    if (options.recursive && !top.dirs.empty()) {
+        std::mutex handler_mutex;
+        ThreadPool pool(SCAN_THREADS_MAX, SCAN_THREADS_PER_CORE);
+        std::function<void(const std::filesystem::path&)> scan =
+            [&](const std::filesystem::path& dir) {
+                if (!proceed) {
+                    return;
+                }
+                ScanResult result =
+                    read_dir(dir, mask, options.exts.get(), cached);
+                for (const std::filesystem::path& it : result.dirs) {
+                    pool.add(scan, it);
+                }
+                Batch batch;
+                batch.files = std::move(result.files);
+                if (options.fsmon) {
+                    batch.watch.emplace_back(dir);
+                }
+                const std::scoped_lock lock(handler_mutex);
+                if (proceed && !handler(std::move(batch))) {
+                    proceed = false;
+                    pool.cancel();
+                }
+            };
+        for (const std::filesystem::path& it : top.dirs) {
+            pool.add(scan, it);
+        }
+        pool.wait();
+    }
+
+    return proceed;
 }
 
-ImageList::EntriesArray ImageList::add_dir(const std::filesystem::path& path)
+void ImageList::set_extensions(const std::vector<std::string>& exts)
 {
-    EntriesArray added;
+    std::shared_ptr<Extensions> filter;
 
+    for (std::string ext : exts) {
+        if (ext.starts_with('.')) {
+            ext.erase(0, 1);
+        }
+        if (!ext.empty()) {
+            if (!filter) {
+                filter = std::make_shared<Extensions>();
+            }
+            filter->insert(to_lower(ext));
+        }
+    }
+
+    const std::scoped_lock lock(extensions_mutex);
+    extensions = filter;
+}
+
+std::shared_ptr<const ImageList::Extensions> ImageList::get_extensions() const
+{
+    const std::scoped_lock lock(extensions_mutex);
+    return extensions;
+}
+
+bool ImageList::allowed(const Extensions& exts,
+                        const std::filesystem::path& path)
+{
+    const std::string ext = path.extension();
+    return !ext.empty() && exts.contains(to_lower(ext.substr(1)));
+}
+
+ImageList::EntriesArray ImageList::add_batch(const Batch& batch)
+{
     if (fsmon) {
-        FsMonitor::self().add(path);
+        FsMonitor& monitor = FsMonitor::self();
+        for (const std::filesystem::path& it : batch.watch) {
+            monitor.add(it);
+        }
     }
 
-    try {
-        for (const auto& it : std::filesystem::directory_iterator(path)) {
-            const std::filesystem::path& child_path = it.path();
-            if (std::filesystem::is_directory(child_path)) {
-                if (recursive) {
-                    EntriesArray entries = add_dir(child_path);
-                    added.reserve(added.size() + entries.size());
-                    added.insert(added.end(), entries.begin(), entries.end());
-                }
-            } else {
-                const ImageEntryPtr entry = add_file(child_path);
-                if (entry) {
-                    added.push_back(entry);
-                }
-            }
+    EntriesArray added;
+    added.reserve(batch.files.size());
+    for (const File& it : batch.files) {
+        const ImageEntryPtr entry = add_entry(it.path, it.mtime, it.size);
+        if (entry) {
+            added.push_back(entry);
         }
-    } catch (const std::filesystem::filesystem_error&) {
     }
 
+    insert(added);
+
     return added;
 }
 
-ImageEntryPtr ImageList::add_file(const std::filesystem::path& path)
+ImageEntryPtr ImageList::find_entry(const std::filesystem::path& path) const
 {
-    assert(path.is_absolute());
-
-    if (!std::filesystem::is_regular_file(path)) {
-        Log::warning("File {} is not a regular, skipped", path.string());
+    const std::filesystem::path parent = path.parent_path();
+    const auto dir = dirs.find(parent);
+    if (dir == dirs.end()) {
         return nullptr;
     }
 
-    const auto fs_time = std::filesystem::last_write_time(path);
-    auto sys_time =
-        std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-            fs_time - std::filesystem::file_time_type::clock::now() +
-            std::chrono::system_clock::now());
-    const std::time_t mtime = std::chrono::system_clock::to_time_t(sys_time);
-
-    const size_t size = std::filesystem::file_size(path);
+    const std::string_view name =
+        std::string_view(path.native()).substr(parent.native().size());
+    const auto it = entries_set.find(EntryKey(dir->second.get(), name));
+    return it == entries_set.end() ? nullptr : *it;
+}
 
-    return add_entry(path, mtime, size);
+ImageEntryDirPtr ImageList::intern_dir(const std::filesystem::path& path)
+{
+    auto it = dirs.find(path);
+    if (it == dirs.end()) {
+        const ImageEntryDirPtr dir = std::make_shared<ImageEntryDir>();
+        dir->path = path;
+        dir->key = make_dir_key(path, order == Order::Numeric);
+        it = dirs.emplace(path, dir).first;
+    }
+    return it->second;
 }
 
 ImageEntryPtr ImageList::add_entry(const std::filesystem::path& path,
@@ -547,25 +1061,106 @@ ImageEntryPtr ImageList::add_entry(const std::filesystem::path& path,
 {
     ImageEntryPtr entry = nullptr;
 
-    if (!entries_map.contains(path)) {
+    if (!find_entry(path)) {
         entry = std::make_shared<ImageEntry>();
-        entry->path = path;
+        entry->set_path(path, intern_dir(path.parent_path()));
         entry->mtime = mtime;
         entry->size = size;
-        entries_map.insert({ entry->path, entry });
-        entries_arr.push_back(entry);
+        entries_set.insert(entry);
     }
 
     return entry;
 }
 
+void ImageList::insert(const EntriesArray& entries)
+{
+    if (entries.empty()) {
+        return;
+    }
+
+    for (const ImageEntryPtr& entry : entries) {
+        ++entry->dir->count;
+    }
+
+    // incremental insertion builds sort keys of ~log2(N) list entries for
+    // each new one, while the full sort builds keys of all entries once
+    size_t ratio = INCREMENTAL_RATIO;
+    if (order != Order::None && order != Order::Random) {
+        ratio = std::max(ratio, static_cast<size_t>(std::bit_width(total)));
+    }
+    if (entries.size() * ratio > total) {
+        EntriesArray all = flatten();
+        all.insert(all.end(), entries.begin(), entries.end());
+        sort(all);
+        rebuild(all);
+        return;
+    }
+
+    static std::random_device rdev;
+    static std::mt19937 engine(rdev());
+
+    for (const ImageEntryPtr& entry : entries) {
+        size_t index = total;
+        if (order == Order::Random) {
+            index = std::uniform_int_distribution<size_t>(0, total)(engine);
+        } else if (order != Order::None) {
+            if ((order == Order::Mtime && !entry->mtime) ||
+                (order == Order::Size && !entry->size)) {
+                entry->load_stat();
+            }
+            // binary search for the upper bound
+            const SortItem item = make_item(entry);
+            size_t low = 0;
+            while (low < index) {
+                const size_t mid = low + (index - low) / 2;
+                if (before(item, make_item(at(mid)))) {
+                    index = mid;
+                } else {
+                    low = mid + 1;
+                }
+            }
+        }
+        insert_at(index, entry);
+    }
+}
+
+void ImageList::erase(const EntriesArray& entries)
+{
+    std::vector<std::pair<size_t, ImageEntryPtr>> indices;
+    indices.reserve(entries.size());
+    for (const ImageEntryPtr& entry : entries) {
+        indices.emplace_back(entry->index(), entry);
+        --entry->dir->count;
+    }
+
+    if (entries.size() * INCREMENTAL_RATIO > total) {
+        EntriesArray all = flatten();
+        std::erase_if(all, [](const ImageEntryPtr& entry) {
+            return entry->removed;
+        });
+        rebuild(all);
+    } else {
+        // from the end, so indices of the rest are not changed
+        std::ranges::sort(indices, std::greater {},
+                          &std::pair<size_t, ImageEntryPtr>::first);
+        for (const auto& [index, _] : indices) {
+            erase_at(index);
+        }
+    }
+
+    for (const auto& [index, entry] : indices) {
+        entry->set_index(index);
+    }
+}
+
 void ImageList::sort()
 {
-    sort(entries_arr);
-    reindex();
+    EntriesArray all = flatten();
+    sort(all);
+    rebuild(all);
 }
 
-void ImageList::sort(EntriesArray& entries) const
+void ImageList::sort(EntriesArray& entries)
 {
     if (order == Order::None) {
         // nothing to do
@@ -577,18 +1172,202 @@ void ImageList::sort(EntriesArray& entries) const
         std::shuffle(tmp.begin(), tmp.end(), engine);
         entries.assign(tmp.begin(), tmp.end());
     } else {
-        std::sort(entries.begin(), entries.end(),
-                  [this](const ImageEntryPtr& l, const ImageEntryPtr& r) {
-                      const bool cmp = compare_entries(*l, *r, order);
-                      return reverse ? !cmp : cmp;
+        // attributes may be not loaded if list was scanned in other order
+        if (order == Order::Mtime || order == Order::Size) {
+            for (const ImageEntryPtr& entry : entries) {
+                if (order == Order::Mtime ? !entry->mtime : !entry->size) {
+                    entry->load_stat();
+                }
+            }
+        }
+
+        // keys are freed after sorting
+        std::vector<SortItem> items;
+        items.reserve(entries.size());
+        for (const ImageEntryPtr& entry : entries) {
+            items.emplace_back(make_item(entry));
+        }
+        std::sort(items.begin(), items.end(),
+                  [this](const SortItem& l, const SortItem& r) {
+                      return before(l, r);
                   });
+        for (size_t i = 0; i < items.size(); ++i) {
+            entries[i] = std::move(items[i].entry);
+        }
+    }
+}
+
+ImageList::SortItem ImageList::make_item(const ImageEntryPtr& entry) const
+{
+    const std::filesystem::path name(entry->name);
+    return { .key = make_key(name.filename(), order == Order::Numeric),
+             .entry = entry };
+}
+
+bool ImageList::before(const SortItem& l, const SortItem& r) const
+{
+    return reverse
+        ? compare_entries(*r.entry, r.key, *l.entry, l.key, order)
+        : compare_entries(*l.entry, l.key, *r.entry, r.key, order);
+}
+
+ImageList::EntriesArray ImageList::flatten() const
+{
+    EntriesArray all;
+    all.reserve(total);
+    for (const GroupPtr& grp : groups) {
+        all.insert(all.end(), grp->entries.begin(), grp->entries.end());
+    }
+    return all;
+}
+
+void ImageList::rebuild(const EntriesArray& entries)
+{
+    while (!groups.empty()) {
+        release(std::move(groups.back()));
+        groups.pop_back();
+    }
+
+    total = entries.size();
+    runs.clear();
+
+    for (size_t start = 0; start < total; start += GROUP_SIZE) {
+        GroupPtr grp = make_group();
+        grp->start.store(start, std::memory_order_relaxed);
+        const size_t end = std::min(start + GROUP_SIZE, total);
+        grp->entries.assign(entries.begin() + start, entries.begin() + end);
+        for (size_t i = 0; i < grp->entries.size(); ++i) {
+            grp->entries[i]->set_position(grp.get(), i);
+        }
+        groups.emplace_back(std::move(grp));
+    }
+
+    for (size_t i = 0; i < total; ++i) {
+        if (i == 0 || entries[i - 1]->dir != entries[i]->dir) {
+            runs.insert(runs.end(), entries[i].get());
+        }
     }
 }
 
-void ImageList::reindex(const size_t index)
+const ImageEntryPtr& ImageList::at(const size_t index) const
 {
-    const size_t sz = entries_arr.size();
-    for (size_t i = index; i < sz; ++i) {
-        entries_arr[i]->index = i;
+    assert(index < total);
+    const Group& grp = *groups[group_of(index)];
+    return grp.entries[index - grp.start];
+}
+
+void ImageList::insert_at(const size_t index, const ImageEntryPtr& entry)
+{
+    assert(index <= total);
+
+    if (groups.empty()) {
+        groups.emplace_back(make_group());
+    }
+
+    const size_t grp_idx = index == total ? groups.size() - 1 : group_of(index);
+    Group& grp = *groups[grp_idx];
+    const size_t offset = index - grp.start;
+
+    grp.entries.insert(grp.entries.begin() + offset, entry);
+    for (size_t i = offset; i < grp.entries.size(); ++i) {
+        grp.entries[i]->set_position(&grp, i);
+    }
+
+    for (size_t i = grp_idx + 1; i < groups.size(); ++i) {
+        shift(*groups[i], 1);
+    }
+    ++total;
+
+    // split the group
+    if (grp.entries.size() > GROUP_SIZE * 2) {
+        GroupPtr tail = make_group();
+        tail->start.store(grp.start + GROUP_SIZE, std::memory_order_relaxed);
+        tail->entries.assign(grp.entries.begin() + GROUP_SIZE,
+                             grp.entries.end());
+        for (size_t i = 0; i < tail->entries.size(); ++i) {
+            tail->entries[i]->set_position(tail.get(), i);
+        }
+        grp.entries.resize(GROUP_SIZE);
+        groups.insert(groups.begin() + grp_idx + 1, std::move(tail));
+    }
+
+    // only the new entry and the next one can change their run state
+    update_run(index);
+    if (index + 1 < total) {
+        update_run(index + 1);
+    }
+}
+
+void ImageList::erase_at(const size_t index)
+{
+    assert(index < total);
+
+    const auto run = runs.find(index);
+    if (run != runs.end()) {
+        runs.erase(run);
+    }
+
+    const size_t grp_idx = group_of(index);
+    Group& grp = *groups[grp_idx];
+    const size_t offset = index - grp.start;
+
+    grp.entries.erase(grp.entries.begin() + offset);
+    for (size_t i = offset; i < grp.entries.size(); ++i) {
+        grp.entries[i]->set_position(&grp, i);
     }
+
+    for (size_t i = grp_idx + 1; i < groups.size(); ++i) {
+        shift(*groups[i], -1);
+    }
+    --total;
+
+    if (grp.entries.empty()) {
+        release(std::move(groups[grp_idx]));
+        groups.erase(groups.begin() + grp_idx);
+    }
+
+    // the next entry may become a head of the run
+    if (index < total) {
+        update_run(index);
+    }
+}
+
+void ImageList::update_run(const size_t index)
+{
+    const ImageEntry* entry = at(index).get();
+    const bool head = index == 0 || at(index - 1)->dir != entry->dir;
+    const auto it = runs.find(index);
+    if (head && it == runs.end()) {
+        runs.insert(entry);
+    } else if (!head && it != runs.end()) {
+        runs.erase(it);
+    }
+}
+
+size_t ImageList::group_of(const size_t index) const
+{
+    assert(!groups.empty());
+
+    // the last group that starts at or before the index
+    const auto it = std::upper_bound(
+        groups.begin() + 1, groups.end(), index,
+        [](const size_t idx, const GroupPtr& grp) { return idx < grp->start; });
+    return std::distance(groups.begin(), it) - 1;
+}
+
+ImageList::GroupPtr ImageList::make_group()
+{
+    if (spare.empty()) {
+        return std::make_unique<Group>();
+    }
+    GroupPtr grp = std::move(spare.back());
+    spare.pop_back();
+    return grp;
+}
+
+void ImageList::release(GroupPtr&& group)
+{
+    group->start.store(0, std::memory_order_relaxed);
+    group->entries.clear();
+    spare.emplace_back(std::move(group));
 }
@@ -4,11 +4,19 @@
 
 #pragma once
 
+#include "dircache.hpp"
 #include "image.hpp"
 
 #include <ctime>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 /** Thread-safe list of images. */
@@ -36,7 +44,41 @@ public:
     };
 
     using EntriesArray = std::vector<ImageEntryPtr>;
-    using EntriesMap = std::unordered_map<std::filesystem::path, ImageEntryPtr>;
+
+    /** Image file found by scanner, but not yet added to the list. */
+    struct File {
+        std::filesystem::path path; ///< Absolute path or special source
+        std::time_t mtime = 0;      ///< Modification time, 0 if not loaded
+        size_t size = 0;            ///< Size of the file, 0 if not loaded
+    };
+
+    /** Batch of scanned files. */
+    struct Batch {
+        std::vector<File> files;                  ///< Found files
+        std::vector<std::filesystem::path> watch; ///< Paths for FS monitor
+    };
+
+    /**
+     * Scanned batch handler.
+     * @return false to stop scanning
+     */
+    using BatchHandler = std::function<bool(Batch&&)>;
+
+    /** Set of file extensions in lower case. */
+    using Extensions = std::unordered_set<std::string>;
+
+    /**
+     * Scanner settings, a copy of the list settings taken before scanning, so
+     * the scanning thread is not affected by changing the list settings.
+     */
+    struct ScanOptions {
+        unsigned int mask = 0;  ///< statx mask with attributes for sorting
+        bool recursive = false; ///< Read directories recursively
+        bool adjacent = false;  ///< Add adjacent files from the same directory
+        bool fsmon = false;     ///< Collect paths for FS monitor
+        std::filesystem::path cache; ///< Listing cache file, empty to disable
+        std::shared_ptr<const Extensions> exts; ///< Filter, nullptr for all
+    };
 
     /**
      * Get global instance of image list.
@@ -54,6 +96,52 @@ public:
      */
     EntriesArray add(const std::vector<std::filesystem::path>& sources);
 
+    /**
+     * Get current extension filter (thread safe).
+     * @return set of allowed extensions, nullptr to allow all files
+     */
+    std::shared_ptr<const Extensions> get_extensions() const;
+
+    /**
+     * Check if the file passes the extension filter.
+     * @param exts set of allowed extensions
+     * @param path path to the file
+     * @return true if file can be added to the list
+     */
+    static bool allowed(const Extensions& exts,
+                        const std::filesystem::path& path);
+
+    /**
+     * Add scanned files to the list.
+     * @param batch batch of scanned files
+     * @return list of added entries in list order
+     */
+    EntriesArray add(const Batch& batch);
+
+    /**
+     * Get current scanner settings.
+     * @return scanner settings
+     */
+    [[nodiscard]] ScanOptions get_scan_options() const;
+
+    /**
+     * Scan sources without modifying the list, can be called from any thread.
+     * The handler is called one or more times for each source in source
+     * order, the calls are serialized but may come from other threads.
+     * @param sources list of sources to scan
+     * @param options scanner settings
+     * @param handler callback to receive found files
+     */
+    void scan(const std::vector<std::filesystem::path>& sources,
+              const ScanOptions& options, const BatchHandler& handler) const;
+
+    /**
+     * Save directory listing cache if it was changed by scanning.
+     * Rewrites the whole cache file, so it is not called from the UI thread
+     * while the application is running.
+     */
+    void save_cache() const;
+
     /**
      * Remove all given paths from the list.
      * @param sources entries paths to remove
@@ -67,6 +155,13 @@ public:
      */
     void remove(const ImageEntryPtr& entry);
 
+    /**
+     * Reload file attributes of modified entries and move them to the new
+     * position if the attributes are the sorting keys.
+     * @param entries modified entries
+     */
+    void refresh(const EntriesArray& entries);
+
     /**
      * Clear image list.
      * @return list of removed entries
@@ -103,6 +198,12 @@ public:
      */
     bool get_reverse() const { return reverse; }
 
+    /**
+     * Set allowed file extensions, other files are skipped while scanning.
+     * @param exts list of extensions (case insensitive), empty to allow all
+     */
+    void set_extensions(const std::vector<std::string>& exts);
+
     /**
      * Find image entry by source path.
      * @param path path to the file or special source
@@ -132,6 +233,13 @@ public:
      */
     ImageEntryPtr get(const ImageEntryPtr& from, const ssize_t distance);
 
+    /**
+     * Get entries in the specified range of indices.
+     * @param first,last range of indices [first,last], clipped by list size
+     * @return array of entries in list order
+     */
+    EntriesArray get_range(const size_t first, const size_t last);
+
     /**
      * Get distance between two image entries.
      * @param from,to image entries
@@ -139,6 +247,12 @@ public:
      */
     ssize_t distance(const ImageEntryPtr& from, const ImageEntryPtr& to);
 
+    /**
+     * Get number of entries in each parent directory.
+     * @return array of directory paths with number of entries in them
+     */
+    std::vector<std::pair<std::filesystem::path, size_t>> get_dirs();
+
 private:
     /**
      * Get child entries by directory path.
@@ -156,28 +270,50 @@ private:
     ImageEntryPtr get_diffparent(const ImageEntryPtr& from, const bool forward);
 
     /**
-     * Add file, directory or special source to the list.
+     * Scan file, directory or special source.
      * @param path path to the file or special source
-     * @return list of added entries
+     * @param options scanner settings
+     * @param handler callback to receive found files
+     * @return false if scanning was stopped by handler
      */
-    EntriesArray add_any(const std::filesystem::path& path);
+    bool scan_any(const std::filesystem::path& path,
+                  const ScanOptions& options,
+                  const BatchHandler& handler) const;
 
     /**
-     * Add files from the directory to the list.
+     * Scan files in the directory.
      * @param path path to the directory
-     * @return list with added entries
+     * @param options scanner settings
+     * @param handler callback to receive found files
+     * @return false if scanning was stopped by handler
      */
-    EntriesArray add_dir(const std::filesystem::path& path);
+    bool scan_dir(const std::filesystem::path& path,
+                  const ScanOptions& options,
+                  const BatchHandler& handler) const;
 
     /**
-     * Add file to the list.
-     * @param path path to the file
-     * @return added entry
+     * Add scanned files to the list.
+     * @param batch batch of scanned files
+     * @return list of added entries
+     */
+    EntriesArray add_batch(const Batch& batch);
+
+    /**
+     * Find entry by its absolute path.
+     * @param path path to the image file or special source
+     * @return image entry or nullptr if entry not found
+     */
+    ImageEntryPtr find_entry(const std::filesystem::path& path) const;
+
+    /**
+     * Get interned parent directory, create it if not exists.
+     * @param path path to the directory
+     * @return directory instance
      */
-    ImageEntryPtr add_file(const std::filesystem::path& path);
+    ImageEntryDirPtr intern_dir(const std::filesystem::path& path);
 
     /**
-     * Add new entry to the list.
+     * Create new entry, it must be inserted to the list by the caller.
      * @param path path to the image file
      * @param mtime file modification time
      * @param size size of the file
@@ -187,7 +323,19 @@ private:
                             const std::time_t mtime = 0, const size_t size = 0);
 
     /**
-     * Sort and reindex image list.
+     * Insert new entries to the list according to the current order.
+     * @param entries entries to insert
+     */
+    void insert(const EntriesArray& entries);
+
+    /**
+     * Erase entries from the list, removed entries keep their last index.
+     * @param entries entries to erase, already marked as removed
+     */
+    void erase(const EntriesArray& entries);
+
+    /**
+     * Sort the whole image list.
      */
     void sort();
 
@@ -195,20 +343,180 @@ private:
      * Sort specified image list.
      * @param entries image list to sort
      */
-    void sort(EntriesArray& entries) const;
+    void sort(EntriesArray& entries);
+
+    /**
+     * Entry with its file name sort key. Keys are built only for sorting and
+     * are not stored in entries: a key is often several times longer than
+     * the name.
+     */
+    struct SortItem {
+        std::string key;     ///< File name sort key
+        ImageEntryPtr entry; ///< Image entry
+    };
+
+    /**
+     * Make sort item for the entry according to the current order.
+     * @param entry image entry
+     * @return sort item
+     */
+    SortItem make_item(const ImageEntryPtr& entry) const;
+
+    /**
+     * Compare entries according to the current order.
+     * @param l,r entries to compare
+     * @return true if l must be placed before r
+     */
+    bool before(const SortItem& l, const SortItem& r) const;
+
+    /** Group of adjacent entries, the unit of index maintenance. */
+    struct Group : ImageEntryGroup {
+        EntriesArray entries; ///< Entries of the group in list order
+    };
+    using GroupPtr = std::unique_ptr<Group>;
+
+    /**
+     * Get all entries of the list.
+     * @return array with all entries in list order
+     */
+    EntriesArray flatten() const;
+
+    /**
+     * Replace content of the list.
+     * @param entries ordered entries to set
+     */
+    void rebuild(const EntriesArray& entries);
+
+    /**
+     * Get entry by its index.
+     * @param index index of the entry, must be less than list size
+     * @return image entry
+     */
+    const ImageEntryPtr& at(const size_t index) const;
 
     /**
-     * Reindex the image list.
-     * @param index (0-based) to start reindexing from
+     * Insert entry at specified position.
+     * @param index position in the list
+     * @param entry entry to insert
      */
-    void reindex(const size_t index = 0);
+    void insert_at(const size_t index, const ImageEntryPtr& entry);
+
+    /**
+     * Erase entry at specified position.
+     * @param index position in the list
+     */
+    void erase_at(const size_t index);
+
+    /**
+     * Update directory run index for the entry at specified position.
+     * @param index position in the list
+     */
+    void update_run(const size_t index);
+
+    /**
+     * Get group that contains the entry with specified index.
+     * @param index index of the entry
+     * @return position of the group in groups array
+     */
+    size_t group_of(const size_t index) const;
+
+    /**
+     * Get empty group, reuse released one if possible.
+     * @return group instance
+     */
+    GroupPtr make_group();
+
+    /**
+     * Release group, it is kept for reuse.
+     * @param group group to release
+     */
+    void release(GroupPtr&& group);
 
 private:
-    EntriesArray entries_arr; ///< Array of image entries
-    EntriesMap entries_map;   ///< Map of path to image entries
+    // Entries refer to their group to compute the index, so insertion or
+    // removal touches only one group and shifts start of the following ones.
+    // Groups are never freed while the list exists: other threads may compute
+    // an index of the entry during the list modification.
+    std::vector<GroupPtr> groups; ///< Groups of entries in list order
+    std::vector<GroupPtr> spare;  ///< Released groups
+    size_t total = 0;             ///< Total number of entries
+
+    /** Order of run heads by their current index. */
+    struct RunLess {
+        using is_transparent = void;
+        bool operator()(const ImageEntry* l, const ImageEntry* r) const
+        {
+            return l->index() < r->index();
+        }
+        bool operator()(const ImageEntry* l, const size_t r) const
+        {
+            return l->index() < r;
+        }
+        bool operator()(const size_t l, const ImageEntry* r) const
+        {
+            return l < r->index();
+        }
+    };
+
+    // Run is a sequence of adjacent entries from the same directory. Heads
+    // are kept ordered by index: insertion or removal of other entries
+    // doesn't change their relative order, so the set stays valid while
+    // the indices are shifted.
+    std::set<const ImageEntry*, RunLess> runs; ///< First entries of runs
+
+    /** Key to search entries: parent directory and the rest of the path. */
+    struct EntryKey {
+        EntryKey(const ImageEntryDir* dir, const std::string_view name)
+            : dir(dir)
+            , name(name)
+        {
+        }
+        EntryKey(const ImageEntryPtr& entry)
+            : dir(entry->dir.get())
+            , name(entry->name)
+        {
+        }
+        bool operator==(const EntryKey&) const = default;
+
+        const ImageEntryDir* dir; ///< Interned parent directory
+        std::string_view name;    ///< Rest of the path
+    };
+
+    /** Hash of entry key. */
+    struct EntryHash {
+        using is_transparent = void;
+        size_t operator()(const EntryKey& key) const
+        {
+            return std::hash<std::string_view> {}(key.name) ^
+                std::hash<const ImageEntryDir*> {}(key.dir);
+        }
+    };
+
+    /** Equality of entry keys. */
+    struct EntryEqual {
+        using is_transparent = void;
+        bool operator()(const EntryKey& l, const EntryKey& r) const
+        {
+            return l == r;
+        }
+    };
+
+    // Entries don't store the full path: the directory part is shared by all
+    // entries inside it, so the set of entries is searched by the pair of
+    // interned directory and the rest of the path.
+    std::unordered_set<ImageEntryPtr, EntryHash, EntryEqual>
+        entries_set; ///< Set of all entries in the list
+    std::unordered_map<std::filesystem::path, ImageEntryDirPtr>
+        dirs; ///< Interned parent directories
 
     std::shared_mutex mutex; ///< Image list mutex
 
+    mutable DirCache dircache; ///< Persistent cache of directory listings
+
+    // the filter is replaced as a whole, so scanners use a snapshot of it
+    std::shared_ptr<const Extensions> extensions; ///< Allowed extensions
+    mutable std::mutex extensions_mutex;          ///< Filter lock
+
     Order order;  ///< Image list order
     bool reverse; ///< Reverse order flag
 
@@ -216,4 +524,7 @@ public:
     bool recursive; ///< Read directories recursively
     bool adjacent;  ///< Open adjacent files from the same directory
     bool fsmon;     ///< FS monitor usage
+
+    bool cache;                       ///< Directory listing cache usage
+    std::filesystem::path cache_path; ///< Path to the cache file
 };
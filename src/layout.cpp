@@ -7,6 +7,7 @@
 #include "defaults.hpp"
 #include "imagelist.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
@@ -33,6 +34,11 @@ void Layout::update()
     }
     assert(!sel_entry->removed);
 
+    if (smooth) {
+        update_smooth(true);
+        return;
+    }
+
     columns = std::max(static_cast<size_t>(1),
                        window.width / (thumb_size + thumb_padding));
     rows = std::max(static_cast<size_t>(1),
@@ -106,6 +112,148 @@ void Layout::update()
     assert(sel_entry == scheme[sel_row * columns + sel_col].img);
 }
 
+void Layout::update_smooth(const bool follow)
+{
+    ImageList& il = ImageList::self();
+    const ImageEntryPtr first_entry = il.get(nullptr, ImageList::Dir::First);
+    const size_t total = il.size();
+    const size_t row_height = thumb_size + thumb_padding;
+
+    columns = std::max(static_cast<size_t>(1), window.width / row_height);
+    rows = std::max(static_cast<size_t>(1), window.height / row_height);
+
+    const size_t total_rows = (total + columns - 1) / columns;
+    const size_t distance = il.distance(first_entry, sel_entry);
+    const size_t sel_abs_row = distance / columns;
+    sel_col = distance % columns;
+
+    // move viewport to make the selected thumbnail fully visible
+    const size_t height = total_rows * row_height + thumb_padding;
+    if (follow) {
+        const size_t sel_top = sel_abs_row * row_height;
+        const size_t sel_bottom = sel_top + row_height + thumb_padding;
+        if (sel_top < view_y) {
+            view_y = sel_top;
+        } else if (sel_bottom > view_y + window.height) {
+            view_y = sel_bottom > window.height ? sel_bottom - window.height : 0;
+        }
+    }
+    view_y = std::min(view_y, height > window.height ? height - window.height
+                                                     : static_cast<size_t>(0));
+
+    // get visible rows, including partially visible
+    const size_t first_row = view_y / row_height;
+    size_t last_row = (view_y + window.height + row_height - 1) / row_height;
+    last_row = std::min(total_rows, last_row) - 1;
+    sel_row = sel_abs_row - first_row;
+
+    // center the layout if it is smaller than the window
+    const size_t used_cols = std::min(columns, total);
+    const size_t mid_x = std::min(window.width, used_cols * row_height);
+    const size_t offset_x = (window.width - mid_x) / 2;
+    const size_t offset_y =
+        height < window.height ? (window.height - height) / 2 : 0;
+
+    // fill thumbnails map
+    scheme.clear();
+    ImageEntryPtr img = il.get(first_entry, first_row * columns);
+    for (size_t row = first_row; img && row <= last_row; ++row) {
+        for (size_t col = 0; img && col < columns; ++col) {
+            Thumbnail thumb;
+            thumb.col = col;
+            thumb.row = row - first_row;
+            thumb.pos.x = offset_x + col * row_height + thumb_padding;
+            thumb.pos.y = static_cast<ssize_t>(offset_y + row * row_height +
+                                               thumb_padding) -
+                static_cast<ssize_t>(view_y);
+            thumb.img = img;
+            scheme.emplace_back(thumb);
+            img = il.get(img, ImageList::Dir::Next);
+        }
+    }
+}
+
+void Layout::select_visible()
+{
+    const ssize_t wnd_height = static_cast<ssize_t>(window.height);
+    const auto visible = [this, wnd_height](const Thumbnail& thumb) {
+        return thumb.pos.y >= 0 &&
+            thumb.pos.y + static_cast<ssize_t>(thumb_size) <= wnd_height;
+    };
+
+    const auto sel = std::ranges::find_if(scheme, [this](const Thumbnail& t) {
+        return t.img == sel_entry;
+    });
+    if (sel != scheme.end() && visible(*sel)) {
+        return; // already visible
+    }
+    const bool above = sel != scheme.end()
+        ? sel->pos.y < 0
+        : ImageList::self().distance(sel_entry, scheme.front().img) > 0;
+
+    // get the nearest fully visible row
+    size_t target_row = std::numeric_limits<size_t>::max();
+    for (const Thumbnail& it : scheme) {
+        if (visible(it)) {
+            target_row = it.row;
+            if (above) {
+                break;
+            }
+        }
+    }
+
+    // select thumbnail in the same column (or the last one in a short row)
+    const Thumbnail* next = nullptr;
+    for (const Thumbnail& it : scheme) {
+        if (it.row == target_row && it.col <= sel_col) {
+            next = &it;
+        }
+    }
+    if (next) {
+        sel_entry = next->img;
+        sel_col = next->col;
+        sel_row = next->row;
+    }
+}
+
+bool Layout::scroll(const ssize_t delta)
+{
+    if (!smooth || scheme.empty()) {
+        return false;
+    }
+
+    const size_t prev = view_y;
+    if (delta < 0) {
+        view_y -= std::min(view_y, static_cast<size_t>(-delta));
+    } else {
+        view_y += delta;
+    }
+    update_smooth(false);
+
+    if (view_y == prev) {
+        return false;
+    }
+
+    select_visible();
+    return true;
+}
+
+void Layout::set_smooth(const bool enable)
+{
+    if (smooth == enable) {
+        return;
+    }
+    smooth = enable;
+    if (smooth && !scheme.empty()) {
+        // start from the currently visible rows
+        ImageList& il = ImageList::self();
+        const ImageEntryPtr first = il.get(nullptr, ImageList::Dir::First);
+        const size_t distance = il.distance(first, scheme.front().img);
+        view_y = (distance / columns) * (thumb_size + thumb_padding);
+    }
+    update();
+}
+
 void Layout::set_window_size(const Size& size)
 {
     window = size;
@@ -60,6 +60,34 @@ public:
      */
     void set_padding(const size_t padding);
 
+    /**
+     * Enable/disable smooth scrolling mode.
+     * In this mode the viewport is positioned with pixel precision and
+     * partially visible rows are included in the scheme.
+     * @param enable flag to set
+     */
+    void set_smooth(const bool enable);
+
+    /**
+     * Check if smooth scrolling mode is enabled.
+     * @return true if smooth scrolling mode is enabled
+     */
+    [[nodiscard]] bool get_smooth() const { return smooth; }
+
+    /**
+     * Scroll viewport (smooth mode only), selection is moved to keep it fully
+     * visible.
+     * @param delta number of pixels to scroll: positive - down, negative - up
+     * @return true if viewport was moved
+     */
+    bool scroll(const ssize_t delta);
+
+    /**
+     * Get vertical position of the viewport (smooth mode only).
+     * @return viewport offset from the top of the layout in pixels
+     */
+    [[nodiscard]] size_t get_scroll() const { return view_y; }
+
     /**
      * Get number of columns in layout scheme.
      * @return number of columns
@@ -119,6 +147,17 @@ public:
     [[nodiscard]] const std::vector<Thumbnail>& get_scheme() const;
 
 private:
+    /**
+     * Update layout in smooth scrolling mode.
+     * @param follow move viewport to make the selected thumbnail visible
+     */
+    void update_smooth(const bool follow);
+
+    /**
+     * Move selection to the nearest fully visible thumbnail.
+     */
+    void select_visible();
+
     size_t thumb_size;             ///< Size of thumbnail in pixels
     size_t thumb_padding;          ///< Padding between thumbnails in pixels
     std::vector<Thumbnail> scheme; ///< Layout scheme of visible thumbnails
@@ -126,6 +165,9 @@ private:
     Size window;          ///< Layout size (output window)
     size_t columns, rows; ///< Size of the layout in thumbnails
 
+    bool smooth = false; ///< Smooth scrolling mode
+    size_t view_y = 0;   ///< Viewport position in smooth scrolling mode
+
     ImageEntryPtr sel_entry = nullptr; ///< Currently selected entry
     size_t sel_col =
         std::numeric_limits<size_t>::max(); ///< Currently selected column
@@ -5,6 +5,7 @@
 #include "luaengine.hpp"
 
 #include "application.hpp"
+#include "fsmonitor.hpp"
 #include "gallery.hpp"
 #include "imageformat.hpp"
 #include "imagelist.hpp"
@@ -787,6 +788,50 @@ void LuaEngine::bind_imagelist_api()
                                          "swayimg.imagelist.fsmon field");
                          ImageList::self().fsmon = enable;
                      })
+        .addProperty(
+            "fsmon_delay",
+            []() {
+                return static_cast<double>(FsMonitor::self().delay) / 1000;
+            },
+            [](const double value) {
+                FsMonitor::self().delay = value * 1000;
+            })
+        .addProperty(
+            "cache",
+            []() {
+                return ImageList::self().cache;
+            },
+            [](const bool value) {
+                ImageList::self().cache = value;
+            })
+        .addProperty(
+            "cache_path",
+            []() {
+                return ImageList::self().cache_path.string();
+            },
+            [](const std::string& value) {
+                ImageList::self().cache_path = value;
+            })
+        .addProperty(
+            "extensions",
+            []() {
+                return nullptr;
+            },
+            [this](const luabridge::LuaRef& val) {
+                std::vector<std::string> exts;
+                if (val.isString()) {
+                    exts.emplace_back(val.tostring());
+                } else if (val.isTable()) {
+                    const size_t arr_sz = val.length();
+                    exts.reserve(arr_sz);
+                    for (size_t i = 1; i <= arr_sz; ++i) {
+                        exts.emplace_back(val[i].tostring());
+                    }
+                } else {
+                    raise_error("Invalid argument type");
+                }
+                ImageList::self().set_extensions(exts);
+            })
         .addProperty("size",
                      []() {
                          return ImageList::self().size();
@@ -837,6 +882,16 @@ void LuaEngine::bind_imagelist_api()
                          }
                          return table;
                      })
+        .addFunction("dirs",
+                     [this]() {
+                         luabridge::LuaRef table =
+                             luabridge::newTable(lua_state);
+                         for (const auto& [path, count] :
+                              ImageList::self().get_dirs()) {
+                             table[path.string()] = count;
+                         }
+                         return table;
+                     })
         .endNamespace()
         .endNamespace();
 }
@@ -1058,6 +1113,14 @@ void LuaEngine::bind_viewer_api(const char* name)
             [mode](const bool value) {
                 mode->imagelist_loop = value;
             })
+        .addProperty(
+            "skip_on_repeat",
+            []() {
+                return nullptr;
+            },
+            [mode](const bool value) {
+                mode->skip_on_repeat = value;
+            })
         .addFunction(
             "enable_loop",
             [mode, name](const bool enable) {
@@ -1705,6 +1768,14 @@ void LuaEngine::bind_gallery_api()
                                          "swayimg.gallery.hover field");
                          Gallery::self().enable_hover(enable);
                      })
+        .addProperty(
+            "smooth_scroll",
+            []() {
+                return nullptr;
+            },
+            [](const bool value) {
+                Gallery::self().enable_smooth_scroll(value);
+            })
         .addProperty(
             "pstore",
             []() {
@@ -1761,6 +1832,35 @@ void LuaEngine::bind_gallery_api()
                                          "swayimg.gallery.cache field");
                          Gallery::self().set_cache_size(size);
                      })
+        .addProperty(
+            "cache_limit",
+            []() {
+                return nullptr;
+            },
+            [](const size_t value) {
+                Gallery::self().set_cache_limit(value * 1024 * 1024);
+            })
+        .addProperty(
+            "loader_threads",
+            []() {
+                return Gallery::self().get_loader_stat().limit;
+            },
+            [](const size_t value) {
+                Gallery::self().set_loader_threads(value);
+            })
+        .addFunction("get_loader_stat",
+                     [this]() {
+                         const Gallery::LoaderStat stat =
+                             Gallery::self().get_loader_stat();
+                         luabridge::LuaRef tbl = luabridge::newTable(lua_state);
+                         tbl["limit"] = stat.limit;
+                         tbl["active"] = stat.active;
+                         tbl["queued"] = stat.queued;
+                         tbl["loaded"] = stat.loaded;
+                         tbl["rate"] = stat.rate;
+                         tbl["cpu"] = stat.cpu;
+                         return tbl;
+                     })
         .addProperty(
             "embedded_thumb",
             []() {
@@ -2030,11 +2130,13 @@ void LuaEngine::execute(const luabridge::LuaRef* ref) const
     }
 }
 
-luabridge::LuaRef LuaEngine::entry_to_table(const ImageEntry& entry) const
+luabridge::LuaRef LuaEngine::entry_to_table(ImageEntry& entry) const
 {
+    entry.load_stat();
+
     luabridge::LuaRef table = luabridge::newTable(lua_state);
-    table["path"] = entry.path.string();
-    table["index"] = entry.index + 1;
+    table["path"] = entry.path().string();
+    table["index"] = entry.index() + 1;
     table["size"] = entry.size;
     table["mtime"] = entry.mtime;
     table["mark"] = entry.mark;
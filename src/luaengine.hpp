@@ -65,8 +65,7 @@ private:
      * @param entry image entry to convert
      * @return Lua table object
      */
-    [[nodiscard]] luabridge::LuaRef
-    entry_to_table(const ImageEntry& entry) const;
+    [[nodiscard]] luabridge::LuaRef entry_to_table(ImageEntry& entry) const;
 
     /**
      * Add reference to Lua object.
@@ -248,6 +248,12 @@ int main(int argc, char* argv[])
                  params.lua_exec = arg;
              });
 
+    args.add('T', "thumbnails", nullptr,
+             "generate thumbnails in persistent storage and exit",
+             [&params](const char*) {
+                 params.thumbs_only = true;
+             });
+
     args.add('a', "appid", "ID", "set application id",
              [&params](const char* arg) {
                  if (!*arg) {
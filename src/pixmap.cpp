@@ -4,6 +4,8 @@
 
 #include "pixmap.hpp"
 
+#include <cstdlib>
+
 Pixmap::Pixmap(const Format format, const size_t width, const size_t height,
                void* data) noexcept
 {
@@ -98,6 +100,27 @@ void Pixmap::flip_vertical()
     }
 }
 
+void Pixmap::shift_vertical(const ssize_t delta)
+{
+    const size_t shift = std::abs(delta);
+    if (shift == 0 || shift >= pm_height) {
+        return;
+    }
+
+    const size_t line_sz = pm_width * pm_bpp;
+    const size_t lines = pm_height - shift;
+    if (delta > 0) {
+        // move down starting from the bottom line
+        for (size_t y = lines; y-- > 0;) {
+            std::memcpy(ptr(0, y + shift), ptr(0, y), line_sz);
+        }
+    } else {
+        for (size_t y = 0; y < lines; ++y) {
+            std::memcpy(ptr(0, y), ptr(0, y + shift), line_sz);
+        }
+    }
+}
+
 void Pixmap::flip_horizontal()
 {
     assert(format() == Format::RGB || format() == Format::ARGB);
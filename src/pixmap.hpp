@@ -153,6 +153,12 @@ public:
      */
     void flip_horizontal();
 
+    /**
+     * Shift pixmap content vertically, the exposed lines are left unchanged.
+     * @param delta number of lines to shift: positive - down, negative - up
+     */
+    void shift_vertical(const ssize_t delta);
+
     /**
      * Rotate pixmap.
      * @param angle rotation angle (only 90, 180, or 270)
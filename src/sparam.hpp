@@ -71,6 +71,7 @@ struct StartupParams {
 
     std::filesystem::path config; ///< Lua config file to load
     std::string lua_exec;         ///< Lua code to execute at start
+    bool thumbs_only = false;     ///< Generate thumbnails and exit (headless)
 
     Lockable<std::string> app_id; ///< Window class name
 
@@ -37,13 +37,13 @@ void Text::initialize()
     Application::self().add_fdpoll(overall_tm.fd, [this]() {
         overall_tm.fd.reset(0, 0);
         overall_tm.show = false;
-        Application::redraw();
+        Application::redraw_text();
     });
     Application::self().add_fdpoll(status_tm.fd, [this]() {
         status.clear();
         status_tm.fd.reset(0, 0);
         status_tm.show = false;
-        Application::redraw();
+        Application::redraw_text();
     });
 }
 
@@ -83,7 +83,7 @@ void Text::set_size(const size_t size)
 void Text::set_spacing(const ssize_t size)
 {
     spacing = size;
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::set_scale(const double scale)
@@ -95,25 +95,25 @@ void Text::set_scale(const double scale)
 void Text::set_padding(const size_t pad)
 {
     padding = pad;
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::set_foreground(const argb_t& color)
 {
     foreground = color;
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::set_background(const argb_t& color)
 {
     background = color;
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::set_shadow(const argb_t& color)
 {
     shadow = color;
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::set_overall_timer(const size_t timeout)
@@ -123,7 +123,7 @@ void Text::set_overall_timer(const size_t timeout)
     if (enable) {
         overall_tm.show = true;
         overall_tm.fd.reset(overall_tm.delay, 0);
-        Application::redraw();
+        Application::redraw_text();
     }
 }
 
@@ -137,7 +137,7 @@ void Text::show()
     enable = true;
     overall_tm.show = true;
     overall_tm.fd.reset(overall_tm.delay, 0);
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::hide()
@@ -145,7 +145,7 @@ void Text::hide()
     enable = false;
     overall_tm.show = false;
     overall_tm.fd.reset(0, 0);
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::clear()
@@ -158,6 +158,8 @@ void Text::clear()
             kv.value.clear();
         }
     }
+
+    Application::redraw_text();
 }
 
 void Text::set_status(const std::string& msg)
@@ -182,7 +184,7 @@ void Text::set_status(const std::string& msg)
     status_tm.show = true;
     status_tm.fd.reset(status_tm.delay, 0);
 
-    Application::redraw();
+    Application::redraw_text();
 }
 
 void Text::reset(const ImagePtr& image)
@@ -209,11 +211,15 @@ void Text::reset(const ImageEntryPtr& entry)
 
     fields.clear();
 
-    set_field(FIELD_FILE_PATH, entry->path);
-    set_field(FIELD_FILE_DIR, entry->path.parent_path().filename());
-    set_field(FIELD_FILE_NAME, entry->path.filename());
+    // the entry may be shown without loading the image (gallery, skipping)
+    entry->load_stat();
+
+    const std::filesystem::path path = entry->path();
+    set_field(FIELD_FILE_PATH, path);
+    set_field(FIELD_FILE_DIR, path.parent_path().filename());
+    set_field(FIELD_FILE_NAME, path.filename());
     set_field(FIELD_FILE_SIZE, std::to_string(entry->size));
-    set_field(FIELD_LIST_INDEX, std::to_string(entry->index + 1));
+    set_field(FIELD_LIST_INDEX, std::to_string(entry->index() + 1));
     set_field(FIELD_LIST_TOTAL, std::to_string(ImageList::self().size()));
 
     // human readable file size
@@ -232,6 +238,9 @@ void Text::reset(const ImageEntryPtr& entry)
 
     // restart timer
     if (enable && overall_tm.delay) {
+        if (!overall_tm.show) {
+            Application::redraw_text();
+        }
         overall_tm.show = true;
         overall_tm.fd.reset(overall_tm.delay, 0);
     }
@@ -250,49 +259,93 @@ void Text::set_field(const std::string& field, const std::string& value)
 
 void Text::update()
 {
+    bool changed = false;
+
     for (auto& block : blocks) {
         for (auto& kv : block) {
-            kv.key.update(font, fields);
-            kv.value.update(font, fields);
+            changed |= kv.key.update(font, fields);
+            changed |= kv.value.update(font, fields);
         }
     }
+
+    if (changed) {
+        Application::redraw_text();
+    }
 }
 
-void Text::draw(Pixmap& target) const
-{
-    // show status message
-    if (status_tm.show && !status.empty()) {
-        // calculate line spacing
-        const ssize_t lspacing =
-            std::clamp(spacing, -static_cast<ssize_t>(status.front().height()),
-                       static_cast<ssize_t>(status.front().height()));
-        // calculate height of a single line
-        size_t line_height = 0;
-        for (const auto& line : status) {
-            if (line && !line_height) {
-                line_height = line.height();
-                break;
-            }
+std::vector<Rectangle> Text::get_areas(const Size& wnd) const
+{
+    if (overlay) {
+        return {}; // window surface is not affected
+    }
+    return calc_areas(wnd);
+}
+
+std::vector<Rectangle> Text::calc_areas(const Size& wnd) const
+{
+    std::vector<Rectangle> areas;
+
+    for (size_t i = 0; i < LAYERS; ++i) {
+        const Rectangle area = get_layer(i, wnd);
+        if (area) {
+            areas.push_back(area);
         }
-        // calculate total height
-        const size_t height =
-            line_height * status.size() + lspacing * (status.size() - 1);
-        // draw status text
-        Point pos(0, target.height() - height - padding);
-        for (const auto& line : status) {
-            pos.x = target.width() / 2 - line.width() / 2;
-            if (line) {
-                draw(line, target, pos);
-            }
-            pos.y += line_height + lspacing;
+    }
+
+    return areas;
+}
+
+std::vector<Rectangle> Text::draw(Pixmap& target) const
+{
+    std::vector<Rectangle> areas;
+
+    for (size_t i = 0; i < LAYERS; ++i) {
+        const Rectangle area = get_layer(i, target);
+        if (area) {
+            draw_layer(i, target, { .x = area.x, .y = area.y });
+            areas.push_back(area);
         }
     }
 
-    // show text layer
-    if (overall_tm.show && !fields.empty()) {
-        for (size_t i = 0; i < blocks.size(); ++i) {
-            draw(static_cast<Position>(i), target);
+    return areas;
+}
+
+Rectangle Text::get_layer(const size_t index, const Size& wnd) const
+{
+    assert(index < LAYERS);
+
+    if (index == STATUS_LAYER) {
+        if (!status_tm.show || status.empty()) {
+            return {};
         }
+        const Dimension dim = get_status_dimension();
+        const size_t offset = shadow_offset(dim.line_height);
+        return { static_cast<ssize_t>(wnd.width / 2 - dim.total_width / 2),
+                 static_cast<ssize_t>(wnd.height - dim.total_height - padding),
+                 dim.total_width + offset, dim.total_height + offset };
+    }
+
+    if (!overall_tm.show || fields.empty()) {
+        return {};
+    }
+    const Dimension dim = get_dimension(blocks[index]);
+    if (!dim.total_width || !dim.total_height) {
+        return {};
+    }
+    const size_t offset = shadow_offset(dim.line_height);
+    return { get_position(static_cast<Position>(index), dim, wnd),
+             Size { dim.total_width + offset, dim.total_height + offset } };
+}
+
+void Text::draw_layer(const size_t index, Pixmap& target,
+                      const Point& pos) const
+{
+    assert(index < LAYERS);
+
+    if (index == STATUS_LAYER) {
+        draw_status(target, pos);
+    } else {
+        draw(static_cast<Position>(index), target, pos);
     }
 }
 
@@ -308,7 +361,7 @@ void Text::refresh()
             }
         }
     }
-    Application::redraw();
+    Application::redraw_text();
 }
 
 Text::Dimension Text::get_dimension(const Block& block) const
@@ -347,12 +400,31 @@ Text::Dimension Text::get_dimension(const Block& block) const
     return dim;
 }
 
-void Text::draw(const Position pos, Pixmap& target) const
+Text::Dimension Text::get_status_dimension() const
 {
-    const Block& block = blocks[static_cast<size_t>(pos)];
-    const Dimension dim = get_dimension(block);
+    Dimension dim {};
+
+    // calculate line spacing
+    dim.line_spacing =
+        std::clamp(spacing, -static_cast<ssize_t>(status.front().height()),
+                   static_cast<ssize_t>(status.front().height()));
+    // calculate height of a single line and max width
+    for (const auto& line : status) {
+        if (line && !dim.line_height) {
+            dim.line_height = line.height();
+        }
+        dim.total_width = std::max(dim.total_width, line.width());
+    }
+    // calculate total height
+    dim.total_height = dim.line_height * status.size() +
+        dim.line_spacing * (status.size() - 1);
 
-    // calculate initial position
+    return dim;
+}
+
+Point Text::get_position(const Position pos, const Dimension& dim,
+                         const Size& wnd) const
+{
     ssize_t x = 0;
     ssize_t y = 0;
     switch (pos) {
@@ -361,24 +433,37 @@ void Text::draw(const Position pos, Pixmap& target) const
             y = padding;
             break;
         case Position::TopRight:
-            x = static_cast<ssize_t>(target.width()) - dim.total_width -
-                padding;
+            x = static_cast<ssize_t>(wnd.width) - dim.total_width - padding;
             y = padding;
             break;
         case Position::BottomLeft:
             x = padding;
-            y = static_cast<ssize_t>(target.height()) - dim.total_height -
-                padding;
+            y = static_cast<ssize_t>(wnd.height) - dim.total_height - padding;
             break;
         case Position::BottomRight:
-            x = static_cast<ssize_t>(target.width()) - dim.total_width -
-                padding;
-            y = static_cast<ssize_t>(target.height()) - dim.total_height -
-                padding;
+            x = static_cast<ssize_t>(wnd.width) - dim.total_width - padding;
+            y = static_cast<ssize_t>(wnd.height) - dim.total_height - padding;
             break;
     }
-    x = std::max(static_cast<ssize_t>(0), x);
-    y = std::max(static_cast<ssize_t>(0), y);
+    return { .x = std::max(static_cast<ssize_t>(0), x),
+             .y = std::max(static_cast<ssize_t>(0), y) };
+}
+
+size_t Text::shadow_offset(const size_t height) const
+{
+    if (shadow.a == argb_t::min) {
+        return 0;
+    }
+    return std::max(height / 24, static_cast<size_t>(1));
+}
+
+void Text::draw(const Position pos, Pixmap& target, const Point& start) const
+{
+    const Block& block = blocks[static_cast<size_t>(pos)];
+    const Dimension dim = get_dimension(block);
+
+    const ssize_t x = start.x;
+    ssize_t y = start.y;
 
     // draw background
     if (background.a != argb_t::min) {
@@ -405,12 +490,27 @@ void Text::draw(const Position pos, Pixmap& target) const
     }
 }
 
+void Text::draw_status(Pixmap& target, const Point& start) const
+{
+    const Dimension dim = get_status_dimension();
+
+    // each line is centered in the message area
+    Point pos = start;
+    for (const auto& line : status) {
+        pos.x = start.x +
+            static_cast<ssize_t>(dim.total_width / 2 - line.width() / 2);
+        if (line) {
+            draw(line, target, pos);
+        }
+        pos.y += dim.line_height + dim.line_spacing;
+    }
+}
+
 void Text::draw(const Pixmap& text, Pixmap& target, const Point& pos) const
 {
     // draw shadow
-    if (shadow.a != argb_t::min) {
-        const size_t offset =
-            std::max(text.height() / 24, static_cast<size_t>(1));
+    const size_t offset = shadow_offset(text.height());
+    if (offset) {
         target.mask(text, pos + Point(offset, offset), shadow);
     }
     // draw text with foreground color
@@ -423,7 +523,7 @@ void Text::Line::clear()
     pm.free();
 }
 
-void Text::Line::update(Font& font,
+bool Text::Line::update(Font& font,
                         const std::map<std::string, std::string>& fields)
 {
     std::string output = scheme;
@@ -458,12 +558,14 @@ void Text::Line::update(Font& font,
     }
 
     // update pixmap
-    if (output != display) {
-        display = output;
-        if (display.empty()) {
-            pm.free();
-        } else {
-            pm = font.render(display);
-        }
+    if (output == display) {
+        return false;
+    }
+    display = output;
+    if (display.empty()) {
+        pm.free();
+    } else {
+        pm = font.render(display);
     }
+    return true;
 }
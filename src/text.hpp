@@ -28,6 +28,9 @@ public:
     /** Block scheme description. */
     using Scheme = std::vector<std::string>;
 
+    /** Number of text layers: four blocks and the status message. */
+    static constexpr size_t LAYERS = 5;
+
     // Field IDs
     static constexpr const char* FIELD_FILE_PATH = "path";
     static constexpr const char* FIELD_FILE_DIR = "dir";
@@ -161,6 +164,7 @@ public:
 
     /**
      * Reset text overlay (remove all data).
+     * File attributes are loaded if they were not read by the list scanner.
      * @param entry currently displayed image entry
      */
     void reset(const ImageEntryPtr& entry);
@@ -177,11 +181,43 @@ public:
      */
     void update();
 
+    /**
+     * Enable/disable drawing on the separate overlay surface.
+     * @param enable true if text is drawn on the overlay
+     */
+    void set_overlay(const bool enable) { overlay = enable; }
+
+    /**
+     * Get areas of the window surface covered by the text.
+     * @param wnd window size
+     * @return array of areas affected by the next draw call, always empty if
+     *         text is drawn on the overlay surface
+     */
+    [[nodiscard]] std::vector<Rectangle> get_areas(const Size& wnd) const;
+
     /**
      * Draw text overlay on pixmap.
      * @param target destination pixmap
+     * @return array of updated areas
      */
-    void draw(Pixmap& target) const;
+    std::vector<Rectangle> draw(Pixmap& target) const;
+
+    /**
+     * Get area of the text layer on the window.
+     * @param index layer index
+     * @param wnd window size
+     * @return layer area, empty if the layer is not shown
+     */
+    [[nodiscard]] Rectangle get_layer(const size_t index,
+                                      const Size& wnd) const;
+
+    /**
+     * Draw single text layer.
+     * @param index layer index
+     * @param target destination pixmap
+     * @param pos top left corner of the layer on the target pixmap
+     */
+    void draw_layer(const size_t index, Pixmap& target, const Point& pos) const;
 
 private:
     /** Rendered text line. */
@@ -200,8 +236,9 @@ private:
          * Update line.
          * @param font font instance
          * @param fields fields values
+         * @return true if displayed text was changed
          */
-        void update(Font& font,
+        bool update(Font& font,
                     const std::map<std::string, std::string>& fields);
 
         std::string scheme;  ///< Line scheme
@@ -234,17 +271,55 @@ private:
      */
     [[nodiscard]] Dimension get_dimension(const Block& block) const;
 
+    /**
+     * Get status message dimensions.
+     * @return status block dimensions
+     */
+    [[nodiscard]] Dimension get_status_dimension() const;
+
+    /**
+     * Get block position on the window.
+     * @param pos block position type
+     * @param dim block dimensions
+     * @param wnd window size
+     * @return coordinates of the top left corner of the block
+     */
+    [[nodiscard]] Point get_position(const Position pos, const Dimension& dim,
+                                     const Size& wnd) const;
+
+    /**
+     * Get areas covered by the text.
+     * @param wnd window size
+     * @return array of areas
+     */
+    [[nodiscard]] std::vector<Rectangle> calc_areas(const Size& wnd) const;
+
+    /**
+     * Get shadow offset for the text line.
+     * @param height text line height
+     * @return shadow offset in pixels, 0 if shadow is disabled
+     */
+    [[nodiscard]] size_t shadow_offset(const size_t height) const;
+
     /**
      * Reinitialize pixmaps.
      */
     void refresh();
 
     /**
-     * Draw text overlay on the window.
+     * Draw text block.
      * @param pos block position
-     * @param target destination pixmap (window)
+     * @param target destination pixmap
+     * @param start top left corner of the block on the target pixmap
+     */
+    void draw(const Position pos, Pixmap& target, const Point& start) const;
+
+    /**
+     * Draw status message.
+     * @param target destination pixmap
+     * @param start top left corner of the message on the target pixmap
      */
-    void draw(const Position pos, Pixmap& target) const;
+    void draw_status(Pixmap& target, const Point& start) const;
 
     /**
      * Draw text line.
@@ -262,8 +337,13 @@ private:
         bool show;    ///< Current state
     };
 
+    /** Index of the status message layer, blocks use their positions. */
+    static constexpr size_t STATUS_LAYER = 4;
+
     bool enable; ///< Enable/disable text layer
 
+    bool overlay = false; ///< Text is drawn on the overlay surfaces
+
     HideTimeout overall_tm; ///< Overall show timer
     HideTimeout status_tm;  ///< Status show timer
 
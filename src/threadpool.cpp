@@ -8,15 +8,16 @@
 
 // Thread pool limits
 constexpr size_t MIN_THREADS = 1;
-constexpr size_t MAX_THREADS = 8;
+constexpr size_t DEFAULT_THREADS = 8;
 
-ThreadPool::ThreadPool(const size_t max_threads)
+ThreadPool::ThreadPool(const size_t max_threads, const size_t per_core)
 {
     assert(max_threads <= MAX_THREADS);
+    assert(per_core);
 
-    threads =
-        std::clamp(static_cast<size_t>(std::thread::hardware_concurrency()),
-                   MIN_THREADS, max_threads ? max_threads : MAX_THREADS);
+    const size_t cores = std::thread::hardware_concurrency();
+    threads = std::clamp(cores * per_core, MIN_THREADS,
+                         max_threads ? max_threads : DEFAULT_THREADS);
     start();
 }
 
@@ -76,25 +77,24 @@ void ThreadPool::start()
     assert(active.empty());
 
     quit = false;
-
-    workers.reserve(threads);
-    for (size_t i = 0; i < threads; ++i) {
-        workers.emplace_back(&ThreadPool::run, this);
-    }
 }
 
 void ThreadPool::stop()
 {
-    cancel();
+    std::vector<std::thread> stopping;
+    {
+        const std::scoped_lock lock(mutex);
+        tasks.clear();
+        quit = true;
+        stopping.swap(workers);
+    }
 
-    quit = true;
     tnotify.notify_all();
     complete.notify_all();
 
-    for (auto& it : workers) {
+    for (auto& it : stopping) {
         it.join();
     }
-    workers.clear();
 }
 
 void ThreadPool::run()
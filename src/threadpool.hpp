@@ -14,7 +14,11 @@
 #include <thread>
 #include <vector>
 
-/** Thread pool. */
+/**
+ * Thread pool.
+ * Worker threads are created on demand: a new thread is started only if there
+ * is no idle worker for the added task, up to the size of the pool.
+ */
 class ThreadPool {
 public:
     /** Task description. */
@@ -23,16 +27,20 @@ public:
         std::function<void()> executor; ///< Task function
     };
 
+    /** Upper limit for the number of threads in the pool. */
+    static constexpr size_t MAX_THREADS = 64;
+
     /**
      * Constructor.
-     * @param threads max number of threads in pool
+     * @param max_threads max number of threads in pool, 0 to use default limit
+     * @param per_core number of threads per CPU core
      */
-    ThreadPool(const size_t max_threads = 0);
+    ThreadPool(const size_t max_threads = 0, const size_t per_core = 1);
 
     ~ThreadPool();
 
     /**
-     * Get number of threads in the pool.
+     * Get max number of threads in the pool.
      * @return number of threads
      */
     [[nodiscard]] size_t size() const { return threads; }
@@ -55,6 +63,10 @@ public:
             const std::scoped_lock lock(mutex);
             task_id = ++last_id;
             tasks.emplace_back(Task { task_id, task_fn });
+            if (workers.size() < threads &&
+                tasks.size() + active.size() > workers.size()) {
+                workers.emplace_back(&ThreadPool::run, this);
+            }
         }
 
         tnotify.notify_one();
@@ -85,7 +97,7 @@ public:
     void cancel();
 
     /**
-     * Start worker threads.
+     * Allow to start worker threads.
      */
     void start();
 
@@ -103,7 +115,7 @@ private:
 private:
     size_t threads;                   ///< Size of the poll (number of threads)
     size_t last_id = 0;               ///< Last task id
-    std::vector<std::thread> workers; ///< Array of threads
+    std::vector<std::thread> workers; ///< Array of started threads
 
     std::deque<Task> tasks;          ///< Task queue
     std::condition_variable tnotify; ///< Task queue notification
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: MIT
+// Thumbnail cache.
+// Copyright (C) 2026 Artem Senichev <artemsen@gmail.com>
+
+#include "thumbcache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+ThumbCache::ThumbCache(const size_t limit)
+    : limit(limit)
+{
+}
+
+void ThumbCache::set_limit(const size_t limit)
+{
+    this->limit = limit;
+    shrink();
+}
+
+size_t ThumbCache::count() const
+{
+    size_t total = 0;
+    for (const Shard& it : shards) {
+        const std::scoped_lock lock(it.mutex);
+        total += it.thumbs.size();
+    }
+    return total;
+}
+
+void ThumbCache::set_focus(const size_t first, const size_t last,
+                           const size_t center)
+{
+    focus_first = first;
+    focus_last = last;
+    focus_center = center;
+}
+
+ThumbCache::Thumbnail ThumbCache::get(const ImageEntryPtr& entry) const
+{
+    const Shard& sh = shards[shard(entry)];
+    const std::scoped_lock lock(sh.mutex);
+    const auto it = sh.thumbs.find(entry);
+    return it == sh.thumbs.end() ? nullptr : it->second;
+}
+
+bool ThumbCache::contains(const ImageEntryPtr& entry) const
+{
+    const Shard& sh = shards[shard(entry)];
+    const std::scoped_lock lock(sh.mutex);
+    return sh.thumbs.contains(entry);
+}
+
+void ThumbCache::put(const ImageEntryPtr& entry, Pixmap&& pm)
+{
+    // allocate outside the lock
+    Thumbnail thumb = std::make_shared<const Pixmap>(std::move(pm));
+    const size_t size = bytes(thumb);
+
+    {
+        Shard& sh = shards[shard(entry)];
+        const std::scoped_lock lock(sh.mutex);
+        auto [it, inserted] = sh.thumbs.try_emplace(entry, thumb);
+        if (!inserted) {
+            used -= bytes(it->second);
+            thumb.swap(it->second); // old one is freed outside the lock
+        }
+        used += size;
+    }
+
+    if (used > limit) {
+        shrink();
+    }
+}
+
+void ThumbCache::erase(const ImageEntryPtr& entry)
+{
+    Thumbnail thumb;
+    {
+        Shard& sh = shards[shard(entry)];
+        const std::scoped_lock lock(sh.mutex);
+        const auto it = sh.thumbs.find(entry);
+        if (it == sh.thumbs.end()) {
+            return;
+        }
+        thumb.swap(it->second);
+        sh.thumbs.erase(it);
+        used -= bytes(thumb);
+    }
+}
+
+void ThumbCache::clear()
+{
+    for (Shard& it : shards) {
+        std::unordered_map<ImageEntryPtr, Thumbnail> thumbs;
+        {
+            const std::scoped_lock lock(it.mutex);
+            thumbs.swap(it.thumbs);
+            for (const auto& [_, thumb] : thumbs) {
+                used -= bytes(thumb);
+            }
+        }
+    }
+}
+
+void ThumbCache::shrink()
+{
+    // only one thread performs eviction, others don't need to wait for it
+    const std::unique_lock shrink_lock(shrink_mutex, std::try_to_lock);
+    if (!shrink_lock.owns_lock() || used <= limit) {
+        return;
+    }
+
+    // free a bit more than required to prevent eviction on each insertion
+    const size_t target = limit - limit / 8;
+
+    // collect eviction candidates: all thumbnails outside the focus range
+    const size_t first = focus_first;
+    const size_t last = focus_last;
+    const size_t center = focus_center;
+    std::vector<std::tuple<size_t, ImageEntryPtr, Thumbnail>> candidates;
+    for (const Shard& it : shards) {
+        const std::scoped_lock lock(it.mutex);
+        for (const auto& [entry, thumb] : it.thumbs) {
+            const size_t index = entry->index();
+            if (index < first || index > last) {
+                const size_t distance =
+                    index > center ? index - center : center - index;
+                candidates.emplace_back(distance, entry, thumb);
+            }
+        }
+    }
+
+    // evict the farthest first
+    std::ranges::sort(candidates, [](const auto& a, const auto& b) {
+        return std::get<0>(a) > std::get<0>(b);
+    });
+    for (const auto& [_, entry, thumb] : candidates) {
+        if (used <= target) {
+            break;
+        }
+        Shard& sh = shards[shard(entry)];
+        const std::scoped_lock lock(sh.mutex);
+        const auto it = sh.thumbs.find(entry);
+        if (it != sh.thumbs.end() && it->second == thumb) {
+            sh.thumbs.erase(it);
+            used -= bytes(thumb);
+            ++evicted;
+        }
+    }
+}
+
+size_t ThumbCache::shard(const ImageEntryPtr& entry)
+{
+    // pointers are aligned, drop low bits to distribute entries evenly
+    return (reinterpret_cast<uintptr_t>(entry.get()) >> 4) % SHARDS;
+}
+
+size_t ThumbCache::bytes(const Thumbnail& thumb)
+{
+    return sizeof(Pixmap) + thumb->stride() * thumb->height();
+}
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: MIT
+// Thumbnail cache.
+// Copyright (C) 2026 Artem Senichev <artemsen@gmail.com>
+
+#pragma once
+
+#include "image.hpp"
+#include "pixmap.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * Concurrent thumbnail cache with memory limit.
+ * The cache is split into independently locked shards, so readers never
+ * wait for a writer inserting into another shard, and the pixmaps are shared:
+ * a reader holds the thumbnail without any lock while it is in use.
+ */
+class ThumbCache {
+public:
+    using Thumbnail = std::shared_ptr<const Pixmap>;
+
+    /**
+     * Constructor.
+     * @param limit max size of the cache in bytes
+     */
+    explicit ThumbCache(const size_t limit);
+
+    /**
+     * Set max size of the cache.
+     * @param limit max size of the cache in bytes
+     */
+    void set_limit(const size_t limit);
+
+    /**
+     * Get max size of the cache.
+     * @return max size of the cache in bytes
+     */
+    [[nodiscard]] size_t get_limit() const { return limit; }
+
+    /**
+     * Get current size of the cache.
+     * @return total size of all cached thumbnails in bytes
+     */
+    [[nodiscard]] size_t get_size() const { return used; }
+
+    /**
+     * Get number of cached thumbnails.
+     * @return number of thumbnails
+     */
+    [[nodiscard]] size_t count() const;
+
+    /**
+     * Get total number of evicted thumbnails, used to detect eviction.
+     * @return number of thumbnails evicted since the cache was created
+     */
+    [[nodiscard]] size_t get_evicted() const { return evicted; }
+
+    /**
+     * Set range of entries that must be kept in cache.
+     * @param first,last range of entry indices (visible thumbnails)
+     * @param center index of the entry with the highest priority
+     */
+    void set_focus(const size_t first, const size_t last, const size_t center);
+
+    /**
+     * Get thumbnail.
+     * @param entry image entry
+     * @return thumbnail or nullptr if not cached
+     */
+    [[nodiscard]] Thumbnail get(const ImageEntryPtr& entry) const;
+
+    /**
+     * Check if thumbnail is cached.
+     * @param entry image entry
+     * @return true if thumbnail is in the cache
+     */
+    [[nodiscard]] bool contains(const ImageEntryPtr& entry) const;
+
+    /**
+     * Put thumbnail to the cache, the farthest from focus thumbnails are
+     * evicted if the cache is full.
+     * @param entry image entry
+     * @param pm thumbnail pixmap
+     */
+    void put(const ImageEntryPtr& entry, Pixmap&& pm);
+
+    /**
+     * Remove thumbnail from the cache.
+     * @param entry image entry
+     */
+    void erase(const ImageEntryPtr& entry);
+
+    /**
+     * Remove all thumbnails from the cache.
+     */
+    void clear();
+
+    /**
+     * Evict thumbnails outside the focus range to fit the cache limit.
+     */
+    void shrink();
+
+private:
+    /** Number of shards. */
+    static constexpr size_t SHARDS = 16;
+
+    /** Cache shard. */
+    struct Shard {
+        std::unordered_map<ImageEntryPtr, Thumbnail> thumbs; ///< Thumbnails
+        mutable std::mutex mutex; ///< Shard lock
+    };
+
+    /**
+     * Get shard index for the entry.
+     * @param entry image entry
+     * @return index of the shard
+     */
+    static size_t shard(const ImageEntryPtr& entry);
+
+    /**
+     * Get size of the thumbnail.
+     * @param thumb thumbnail
+     * @return size in bytes
+     */
+    static size_t bytes(const Thumbnail& thumb);
+
+    std::array<Shard, SHARDS> shards; ///< Cache shards
+
+    std::atomic<size_t> limit;    ///< Max size of the cache in bytes
+    std::atomic<size_t> used = 0;    ///< Current size of the cache in bytes
+    std::atomic<size_t> evicted = 0; ///< Total number of evicted thumbnails
+
+    std::atomic<size_t> focus_first = 1;  ///< First index of the focus range
+    std::atomic<size_t> focus_last = 0;   ///< Last index of the focus range
+    std::atomic<size_t> focus_center = 0; ///< Index of the focus center
+
+    std::mutex shrink_mutex; ///< Eviction serialization
+};
@@ -6,6 +6,8 @@
 
 #include "pixmap.hpp"
 
+#include <vector>
+
 class Ui {
 public:
     /** Cursor shapes. */
@@ -82,6 +84,14 @@ public:
      */
     virtual Point get_mouse() { return {}; }
 
+    /**
+     * Check if the last committed frame is not yet shown.
+     * The UI posts AppEvent::FrameReady when the display is ready for the
+     * next frame.
+     * @return true if rendering of the next frame should be postponed
+     */
+    [[nodiscard]] virtual bool frame_pending() const { return false; }
+
     /**
      * Begin window redraw procedure.
      * @return window surface pixmap, nullptr if window not yet created
@@ -90,6 +100,37 @@ public:
 
     /**
      * Finalize window redraw procedure.
+     * @param damage array of updated areas
+     */
+    virtual void commit_surface(const std::vector<Rectangle>& damage) = 0;
+
+    /** Max number of overlay layers. */
+    static constexpr size_t MAX_OVERLAYS = 5;
+
+    /**
+     * Check if overlay layers are supported.
+     * Overlay layers are small transparent surfaces above the window, they
+     * are updated independently from the window content.
+     * @return true if overlay is supported
+     */
+    [[nodiscard]] virtual bool has_overlay() const { return false; }
+
+    /**
+     * Begin overlay layer redraw procedure.
+     * @param index layer index, less than MAX_OVERLAYS
+     * @param area position and size of the layer on the window, empty to hide
+     * @return transparent pixmap of the layer, its top left corner is placed
+     *         at the area position; nullptr if the layer is hidden
+     */
+    virtual Pixmap* lock_overlay(const size_t /*index*/,
+                                 const Rectangle& /*area*/)
+    {
+        return nullptr;
+    }
+
+    /**
+     * Finalize overlay layer redraw procedure.
+     * @param index layer index
      */
-    virtual void commit_surface() = 0;
+    virtual void commit_overlay(const size_t /*index*/) {}
 };
@@ -4,14 +4,15 @@
 
 #include "ui_drm.hpp"
 
+#include "application.hpp"
 #include "log.hpp"
 
 #include <fcntl.h>
-#include <poll.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstring>
 #include <memory>
 
 using DrmResource =
@@ -19,6 +20,50 @@ using DrmResource =
 using DrmConnector =
     std::unique_ptr<drmModeConnector, decltype(&drmModeFreeConnector)>;
 
+namespace {
+// Max number of stale areas tracked for the frame buffer
+constexpr size_t MAX_STALE = 32;
+
+/** DRM object property. */
+struct DrmProperty {
+    uint32_t id = 0;    ///< Property Id, 0 if not found
+    uint64_t value = 0; ///< Current value
+};
+
+/**
+ * Get DRM object property.
+ * @param fd DRM file descriptor
+ * @param object DRM object Id
+ * @param type DRM object type
+ * @param name property name
+ * @return property description
+ */
+DrmProperty get_property(const int fd, const uint32_t object,
+                         const uint32_t type, const char* name)
+{
+    DrmProperty property;
+
+    drmModeObjectPropertiesPtr props =
+        drmModeObjectGetProperties(fd, object, type);
+    if (!props) {
+        return property;
+    }
+    for (uint32_t i = 0; i < props->count_props && !property.id; ++i) {
+        drmModePropertyPtr prop = drmModeGetProperty(fd, props->props[i]);
+        if (prop) {
+            if (std::strcmp(prop->name, name) == 0) {
+                property.id = prop->prop_id;
+                property.value = props->prop_values[i];
+            }
+            drmModeFreeProperty(prop);
+        }
+    }
+    drmModeFreeObjectProperties(props);
+
+    return property;
+}
+} // anonymous namespace
+
 UiDrm::FrameBuffer::~FrameBuffer()
 {
     if (id) {
@@ -73,10 +118,14 @@ bool UiDrm::FrameBuffer::create(const int fd, const Size& sz)
     data = mmap(nullptr, dumb_create.size, PROT_READ | PROT_WRITE, MAP_SHARED,
                 fd, dumb_map.offset);
     if (data == MAP_FAILED) {
+        data = nullptr;
         Log::error(errno, "Unable to create mmap");
         return false;
     }
 
+    pm.attach(Pixmap::RGB, sz.width, sz.height, data, dumb_create.pitch);
+    stale = { Rectangle(0, 0, sz.width, sz.height) };
+
     return true;
 }
 
@@ -149,8 +198,13 @@ bool UiDrm::initialize()
         }
     }
 
+    // dumb buffers are usually write-combined and reading them back (alpha
+    // blending) is extremely slow, so the frame is rendered to the cached
+    // shadow buffer, only damaged areas are copied to the dumb buffer
+    pm.create(Pixmap::RGB, mode.hdisplay, mode.vdisplay);
+
     cfb = &fb[0];
-    pm.attach(Pixmap::RGB, mode.hdisplay, mode.vdisplay, cfb->data);
+    update(*cfb, {});
     conn_id = connector->connector_id;
 
     // save the previous CRTC configuration and set new one
@@ -160,9 +214,25 @@ bool UiDrm::initialize()
         return false;
     }
 
+    // the mode is set with legacy API, atomic commits only flip buffers
+    if (!atomic_init()) {
+        Log::verbose("DRM atomic modesetting is not supported");
+    }
+
     return true;
 }
 
+void UiDrm::run()
+{
+    // page flip events are handled in the application event loop
+    Application::self().add_fdpoll(fd, [this]() {
+        drmEventContext event {};
+        event.version = DRM_EVENT_CONTEXT_VERSION;
+        event.page_flip_handler = &UiDrm::on_page_flipped;
+        drmHandleEvent(fd, &event);
+    });
+}
+
 Size UiDrm::get_window_size()
 {
     return pm;
@@ -173,19 +243,22 @@ Pixmap* UiDrm::lock_surface()
     return &pm;
 }
 
-void UiDrm::commit_surface()
+void UiDrm::commit_surface(const std::vector<Rectangle>& damage)
 {
-    drmEventContext event {};
-    event.version = DRM_EVENT_CONTEXT_VERSION;
-    event.page_flip_handler = &UiDrm::on_page_flipped;
-
-    struct pollfd fds {};
-    fds.fd = fd;
-    fds.events = POLLIN;
+    // accumulate updates until the queued flip is completed
+    const Rectangle full { 0, 0, pm.width(), pm.height() };
+    for (const Rectangle& it : damage) {
+        const Rectangle area = it.intersect(full);
+        if (area) {
+            pending.push_back(area);
+        }
+    }
+    if (pending.size() > MAX_STALE) {
+        pending = { full };
+    }
 
-    drmModePageFlip(fd, crtc_id, cfb->id, DRM_MODE_PAGE_FLIP_EVENT, this);
-    if (poll(&fds, 1, -1) > 0 && fds.revents & POLLIN) {
-        drmHandleEvent(fd, &event);
+    if (!flip_pending) {
+        flip();
     }
 }
 
@@ -293,6 +366,143 @@ drmModeModeInfoPtr UiDrm::get_mode(const drmModeConnectorPtr& connector) const
     return &connector->modes[0]; // use first mode as fallback
 }
 
+bool UiDrm::atomic_init()
+{
+    if (drmSetClientCap(fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) < 0 ||
+        drmSetClientCap(fd, DRM_CLIENT_CAP_ATOMIC, 1) < 0) {
+        return false;
+    }
+
+    drmModePlaneResPtr planes = drmModeGetPlaneResources(fd);
+    if (!planes) {
+        return false;
+    }
+
+    // get primary plane attached to the CRTC by the legacy mode set
+    for (uint32_t i = 0; i < planes->count_planes && !atomic.plane; ++i) {
+        drmModePlanePtr plane = drmModeGetPlane(fd, planes->planes[i]);
+        if (plane) {
+            const DrmProperty type = get_property(
+                fd, plane->plane_id, DRM_MODE_OBJECT_PLANE, "type");
+            if (plane->crtc_id == crtc_id &&
+                type.value == DRM_PLANE_TYPE_PRIMARY) {
+                atomic.plane = plane->plane_id;
+            }
+            drmModeFreePlane(plane);
+        }
+    }
+    drmModeFreePlaneResources(planes);
+
+    if (atomic.plane) {
+        const uint32_t type = DRM_MODE_OBJECT_PLANE;
+        atomic.fb_id = get_property(fd, atomic.plane, type, "FB_ID").id;
+        atomic.damage_clips =
+            get_property(fd, atomic.plane, type, "FB_DAMAGE_CLIPS").id;
+    }
+    if (!atomic.fb_id) {
+        atomic = {};
+        drmSetClientCap(fd, DRM_CLIENT_CAP_ATOMIC, 0);
+        return false;
+    }
+
+    return true;
+}
+
+bool UiDrm::atomic_flip(const uint32_t fb_id)
+{
+    drmModeAtomicReqPtr req = drmModeAtomicAlloc();
+    if (!req) {
+        return false;
+    }
+
+    drmModeAtomicAddProperty(req, atomic.plane, atomic.fb_id, fb_id);
+
+    // damaged areas allow the driver to upload only the changed parts of
+    // the frame (virtual and USB displays)
+    uint32_t blob = 0;
+    if (atomic.damage_clips) {
+        std::vector<drm_mode_rect> clips;
+        clips.reserve(pending.size());
+        for (const Rectangle& it : pending) {
+            clips.push_back({
+                .x1 = static_cast<int32_t>(it.x),
+                .y1 = static_cast<int32_t>(it.y),
+                .x2 = static_cast<int32_t>(it.x + it.width),
+                .y2 = static_cast<int32_t>(it.y + it.height),
+            });
+        }
+        if (drmModeCreatePropertyBlob(fd, clips.data(),
+                                      clips.size() * sizeof(drm_mode_rect),
+                                      &blob) == 0) {
+            drmModeAtomicAddProperty(req, atomic.plane, atomic.damage_clips,
+                                     blob);
+        }
+    }
+
+    const int rc = drmModeAtomicCommit(
+        fd, req, DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, this);
+
+    drmModeAtomicFree(req);
+    if (blob) {
+        drmModeDestroyPropertyBlob(fd, blob);
+    }
+
+    return rc == 0;
+}
+
+void UiDrm::flip()
+{
+    assert(!flip_pending);
+
+    if (pending.empty()) {
+        return; // nothing changed
+    }
+
+    FrameBuffer& next = cfb == &fb[0] ? fb[1] : fb[0];
+    update(next, pending);
+
+    if (atomic.plane && !atomic_flip(next.id)) {
+        Log::warning("DRM atomic commit failed, use legacy API");
+        atomic = {};
+    }
+    if (!atomic.plane &&
+        drmModePageFlip(fd, crtc_id, next.id, DRM_MODE_PAGE_FLIP_EVENT, this) <
+            0) {
+        Log::error(errno, "Unable to flip DRM frame buffer");
+        return;
+    }
+
+    flip_pending = true;
+    pending.clear();
+}
+
+void UiDrm::update(FrameBuffer& target, const std::vector<Rectangle>& damage)
+{
+    const Rectangle full { 0, 0, pm.width(), pm.height() };
+
+    // the other buffer is outdated by this frame
+    for (FrameBuffer& it : fb) {
+        if (&it != &target) {
+            if (it.stale.size() + damage.size() > MAX_STALE) {
+                it.stale = { full }; // too many areas, update the whole buffer
+            } else {
+                it.stale.insert(it.stale.end(), damage.begin(), damage.end());
+            }
+        }
+    }
+
+    // bring the target buffer up to date: the dumb buffer is only written,
+    // whole lines are copied sequentially
+    target.stale.insert(target.stale.end(), damage.begin(), damage.end());
+    for (const Rectangle& it : target.stale) {
+        const Rectangle area = it.intersect(full);
+        if (area) {
+            target.pm.copy(pm.submap(area), { area.x, area.y });
+        }
+    }
+    target.stale.clear();
+}
+
 void UiDrm::on_page_flipped(int, unsigned int, unsigned int, unsigned int,
                             void* data)
 {
@@ -300,6 +510,10 @@ void UiDrm::on_page_flipped(int, unsigned int, unsigned int, unsigned int,
     UiDrm* instance = reinterpret_cast<UiDrm*>(data);
     instance->cfb =
         instance->cfb == &instance->fb[0] ? &instance->fb[1] : &instance->fb[0];
-    instance->pm.attach(Pixmap::RGB, instance->pm.width(),
-                        instance->pm.height(), instance->cfb->data);
+    instance->flip_pending = false;
+
+    // show frames rendered while the flip was in progress
+    instance->flip();
+
+    Application::self().add_event(AppEvent::FrameReady {});
 }
@@ -15,6 +15,7 @@
 
 #include <filesystem>
 #include <string>
+#include <vector>
 
 /** DRM based user interface. */
 class UiDrm : public Ui {
@@ -28,9 +29,11 @@ public:
     bool initialize();
 
     // Implementation of UI generic interface
+    void run() override;
     Size get_window_size() override;
+    [[nodiscard]] bool frame_pending() const override { return flip_pending; }
     Pixmap* lock_surface() override;
-    void commit_surface() override;
+    void commit_surface(const std::vector<Rectangle>& damage) override;
 
 private:
     /**
@@ -66,6 +69,24 @@ private:
     [[nodiscard]] drmModeModeInfoPtr
     get_mode(const drmModeConnectorPtr& connector) const;
 
+    /**
+     * Initialize atomic modesetting: get primary plane and its properties.
+     * @return true if atomic modesetting is supported
+     */
+    bool atomic_init();
+
+    /**
+     * Show frame buffer with atomic commit.
+     * @param fb_id frame buffer Id to show
+     * @return true if commit was successfully queued
+     */
+    bool atomic_flip(const uint32_t fb_id);
+
+    /**
+     * Copy the last rendered frame to the back buffer and queue page flip.
+     */
+    void flip();
+
     // Page flip callback, see DRM API for details
     static void on_page_flipped(int, unsigned int, unsigned int, unsigned int,
                                 void* data);
@@ -95,8 +116,18 @@ private:
         size_t size = 0;      ///< Total size of the buffer (bytes)
         uint32_t id = 0;      ///< DRM buffer Id
         uint32_t handle = 0;  ///< DRM buffer handle
+
+        Pixmap pm;                    ///< Pixmap attached to the buffer data
+        std::vector<Rectangle> stale; ///< Areas outdated by later frames
     };
 
+    /**
+     * Copy the rendered frame to the frame buffer.
+     * @param target destination frame buffer
+     * @param damage array of areas updated in the last frame
+     */
+    void update(FrameBuffer& target, const std::vector<Rectangle>& damage);
+
     int fd = -1;                        ///< DRM file handle
     uint32_t conn_id = 0;               ///< Connector Id
     uint32_t crtc_id = 0;               ///< CRTC Id
@@ -104,5 +135,16 @@ private:
 
     FrameBuffer fb[2];          ///< Frame buffers
     FrameBuffer* cfb = nullptr; ///< Currently displayed frame buffer
-    Pixmap pm;                  ///< Currently displayed pixmap
+    bool flip_pending = false;  ///< Page flip is queued
+
+    std::vector<Rectangle> pending; ///< Areas updated since the last flip
+
+    /** Atomic modesetting. */
+    struct Atomic {
+        uint32_t plane = 0;        ///< Primary plane Id
+        uint32_t fb_id = 0;        ///< Property Id: frame buffer
+        uint32_t damage_clips = 0; ///< Property Id: damaged areas (optional)
+    } atomic;
+
+    Pixmap pm; ///< Shadow buffer in cached memory, frame is rendered here
 };
@@ -14,12 +14,16 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstring>
 #include <format>
 
 // MIME type for drag-and-drop of raw path
 static constexpr const char* MIME_TEXT_PLAIN = "text/plain";
 
+// Size alignment of overlay layer buffers
+static constexpr size_t OVERLAY_ALIGN = 64;
+
 /** Static Wayland handlers. */
 class WaylandHandler {
 public:
@@ -188,10 +192,13 @@ public:
         }
         btn |= ui->mouse_buttons;
 
+        const double scale =
+            static_cast<double>(ui->scale) / UiWayland::FRACTION_SCALE_DEN;
+
         Application::self().add_event(AppEvent::MouseClick {
             .mouse = { .buttons = btn, .mods = ui->xkb.get_modifiers() },
-            .pointer = ui->mouse_pos
-        });
+            .pointer = ui->mouse_pos,
+            .scroll = wl_fixed_to_double(value) * scale });
     }
 
     static constexpr const wl_pointer_listener pointer_listener = {
@@ -332,7 +339,7 @@ public:
             return;
         }
 
-        const std::string path = entry->path.string();
+        const std::string path = entry->path().string();
 
         int err_code = 0;
 
@@ -534,7 +541,10 @@ public:
             wl_callback_add_listener(ui->wl.callback, &frame_listener, ui);
         }
 
-        ui->wnd_buffer.draw_complete();
+        ui->frame_ready = true;
+        ui->flush();
+
+        Application::self().add_event(AppEvent::FrameReady {});
     }
 
     static constexpr const wl_callback_listener frame_listener = {
@@ -632,6 +642,10 @@ public:
             // wayland compositor
             ui->wl.compositor.bind(registry, name,
                                    WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION);
+        } else if (strcmp(interface, wl_subcompositor_interface.name) == 0) {
+            // subsurfaces (text overlay)
+            ui->wl.subcompositor.bind(
+                registry, name, WL_SUBCOMPOSITOR_GET_SUBSURFACE_SINCE_VERSION);
         } else if (strcmp(interface, wl_shm_interface.name) == 0) {
             // wayland shared memory
             ui->wl.shm.bind(registry, name,
@@ -703,7 +717,9 @@ public:
 
 WaylandBuffer::~WaylandBuffer()
 {
-    destroy();
+    for (Shared& it : pool) {
+        destroy(it);
+    }
 }
 
 bool WaylandBuffer::realloc(struct wl_shm* shm, size_t width, size_t height)
@@ -712,8 +728,116 @@ bool WaylandBuffer::realloc(struct wl_shm* shm, size_t width, size_t height)
 
     const std::scoped_lock lock(mutex);
 
-    destroy();
+    // shared buffers are created on demand by the next flush
+    for (Shared& it : pool) {
+        destroy(it);
+    }
+
+    this->shm = shm;
+    pm.free(); // new buffer is fully transparent
+    pm.create(Pixmap::ARGB, width, height);
+    pending.clear();
 
+    return true;
+}
+
+Pixmap* WaylandBuffer::lock()
+{
+    mutex.lock();
+    if (!pm) {
+        mutex.unlock();
+        return nullptr; // not yet created
+    }
+    return &pm;
+}
+
+void WaylandBuffer::unlock(const std::vector<Rectangle>& damage)
+{
+    assert(pm);
+
+    // updates of several frames are merged, skip already covered areas
+    const Rectangle full { 0, 0, pm.width(), pm.height() };
+    for (const Rectangle& it : damage) {
+        const Rectangle area = it.intersect(full);
+        if (!area || std::ranges::any_of(pending, [&area](const Rectangle& r) {
+                return r.intersect(area) == area;
+            })) {
+            continue;
+        }
+        std::erase_if(pending, [&area](const Rectangle& r) {
+            return area.intersect(r) == r;
+        });
+        pending.push_back(area);
+    }
+
+    // too many areas are more expensive for compositor than a bounding box
+    if (pending.size() > MAX_DAMAGE) {
+        Rectangle box;
+        for (const Rectangle& it : pending) {
+            box = box.unite(it);
+        }
+        pending = { box };
+    }
+
+    mutex.unlock();
+}
+
+wl_buffer* WaylandBuffer::flush(std::vector<Rectangle>& damage)
+{
+    // don't wait for the frame being rendered, it will be flushed later
+    const std::unique_lock lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock() || pending.empty()) {
+        return nullptr;
+    }
+
+    // get free buffer, the new ones are created only if all others are busy
+    Shared* shared = nullptr;
+    for (Shared& it : pool) {
+        if (!it.busy && (it.buffer || !shared)) {
+            shared = &it;
+            if (it.buffer) {
+                break;
+            }
+        }
+    }
+    if (!shared || (!shared->buffer && !create(*shared))) {
+        return nullptr; // wait for release
+    }
+
+    // bring the buffer up to date: copy areas changed since its last use
+    const Rectangle full { 0, 0, pm.width(), pm.height() };
+    shared->stale.insert(shared->stale.end(), pending.begin(), pending.end());
+    for (const Rectangle& it : shared->stale) {
+        const Rectangle area = it.intersect(full);
+        if (area) {
+            shared->pm.copy(pm.submap(area), { area.x, area.y });
+        }
+    }
+    shared->stale.clear();
+    shared->busy = true;
+
+    // other buffers are outdated now
+    for (Shared& it : pool) {
+        if (&it != shared && it.buffer) {
+            if (it.stale.size() + pending.size() > POOL_SIZE * MAX_DAMAGE) {
+                it.stale = { full }; // too many areas, update the whole buffer
+            } else {
+                it.stale.insert(it.stale.end(), pending.begin(),
+                                pending.end());
+            }
+        }
+    }
+
+    damage = std::move(pending);
+    pending.clear();
+
+    return shared->buffer;
+}
+
+bool WaylandBuffer::create(Shared& shared)
+{
+    const size_t width = pm.width();
+    const size_t height = pm.height();
     const size_t stride = width * sizeof(argb_t);
     const size_t size = height * stride;
 
@@ -744,60 +868,47 @@ bool WaylandBuffer::realloc(struct wl_shm* shm, size_t width, size_t height)
     }
 
     // create wayland buffer
-    wl_shm_pool* pool = wl_shm_create_pool(shm, fd, size);
-    if (!pool) {
+    wl_shm_pool* shm_pool = wl_shm_create_pool(shm, fd, size);
+    if (!shm_pool) {
         Log::error("Unable create wayland shared poll");
         munmap(data, size);
         return false;
     }
-    buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride,
-                                       WL_SHM_FORMAT_ARGB8888);
-    wl_shm_pool_destroy(pool);
+    shared.buffer = wl_shm_pool_create_buffer(shm_pool, 0, width, height,
+                                              stride, WL_SHM_FORMAT_ARGB8888);
+    wl_shm_pool_destroy(shm_pool);
 
-    pm.attach(Pixmap::ARGB, width, height, data);
+    static constexpr const wl_buffer_listener listener = {
+        .release = on_release,
+    };
+    wl_buffer_add_listener(shared.buffer, &listener, &shared);
+
+    shared.pm.attach(Pixmap::ARGB, width, height, data);
+    shared.stale = { Rectangle(0, 0, width, height) };
+    shared.busy = false;
 
     return true;
 }
 
-Pixmap* WaylandBuffer::lock()
+void WaylandBuffer::destroy(Shared& shared)
 {
-    if (!drawn) {
-        drawn.wait(false); // wait until frame is finished rendering
-    }
-
-    mutex.lock();
-    if (!buffer) {
-        mutex.unlock();
-        return nullptr; // not yet created
-    }
+    if (shared.buffer) {
+        const size_t size = shared.pm.stride() * shared.pm.height();
+        munmap(shared.pm.ptr(0, 0), size);
 
-    drawn = false;
-    return &pm;
-}
+        wl_buffer_destroy(shared.buffer);
 
-void WaylandBuffer::unlock()
-{
-    assert(buffer);
-    mutex.unlock();
-}
-
-void WaylandBuffer::draw_complete()
-{
-    drawn = true;
-    drawn.notify_one();
+        shared.buffer = nullptr;
+        shared.pm.free();
+        shared.stale.clear();
+        shared.busy = false;
+    }
 }
 
-void WaylandBuffer::destroy()
+void WaylandBuffer::on_release(void* data, wl_buffer*)
 {
-    if (buffer) {
-        const size_t size = pm.stride() * pm.height();
-        munmap(pm.ptr(0, 0), size);
-
-        wl_buffer_destroy(buffer);
-
-        buffer = nullptr;
-        pm.free();
-    }
+    // called from the Wayland thread, as well as flush
+    reinterpret_cast<Shared*>(data)->busy = false;
 }
 
 bool UiWayland::initialize(const std::string& app_id)
@@ -866,6 +977,8 @@ bool UiWayland::initialize(const std::string& app_id)
         wl.viewport = wp_viewporter_get_viewport(wl.viewporter, wl.surface);
     }
 
+    create_overlays();
+
     if (wl.ctype_mgr) {
         wl.ctype = wp_content_type_manager_v1_get_surface_content_type(
             wl.ctype_mgr, wl.surface);
@@ -945,22 +1058,19 @@ void UiWayland::run()
                 wl_display_cancel_read(wl.display);
             }
 
-            // buffer flush
+            // buffer flush, also retried after frame done and buffer release
             if (fds[2].revents & POLLIN) {
                 flush_event.reset();
-                wl_surface_attach(wl.surface, wnd_buffer.get(), 0, 0);
-                wl_surface_damage_buffer(wl.surface, 0, 0, wnd_buffer.width(),
-                                         wnd_buffer.height());
-                wl_surface_commit(wl.surface);
             }
+            flush();
 
             // read and handle key repeat events from timer
             if (fds[3].revents & POLLIN) {
                 const auto [key, repeat] = xkb.get_repeat();
                 const keymod_t km = xkb.get_modifiers();
                 for (size_t i = 0; i < repeat; ++i) {
-                    Application::self().add_event(
-                        AppEvent::KeyPress { key, km });
+                    Application::self().add_event(AppEvent::KeyPress {
+                        .key = { key, km }, .repeat = true });
                 }
             }
         }
@@ -1068,13 +1178,222 @@ Point UiWayland::get_mouse()
     return mouse_pos;
 }
 
+bool UiWayland::frame_pending() const
+{
+    return !frame_ready;
+}
+
 Pixmap* UiWayland::lock_surface()
 {
     return wnd_buffer.lock();
 }
 
-void UiWayland::commit_surface()
+void UiWayland::commit_surface(const std::vector<Rectangle>& damage)
 {
+    wnd_buffer.unlock(damage);
     flush_event.set();
-    wnd_buffer.unlock();
+}
+
+bool UiWayland::has_overlay() const
+{
+    return overlays.front().subsurface != nullptr;
+}
+
+Pixmap* UiWayland::lock_overlay(const size_t index, const Rectangle& area)
+{
+    assert(index < overlays.size());
+
+    Overlay& ovl = overlays[index];
+    if (!ovl.subsurface) {
+        return nullptr;
+    }
+
+    const Size window = get_window_size();
+    const Rectangle layer =
+        area.intersect({ 0, 0, window.width, window.height });
+
+    if (!layer) {
+        const std::scoped_lock lock(ovl_mutex);
+        ovl.visible = false;
+        return nullptr;
+    }
+
+    // buffer size is aligned to reuse it while the text width changes
+    // slightly, but the layer must not go beyond the window
+    const auto align = [](size_t size, size_t limit) {
+        size = (size + OVERLAY_ALIGN - 1) / OVERLAY_ALIGN * OVERLAY_ALIGN;
+        return std::min(size, limit);
+    };
+    const Size size {
+        align(layer.width, window.width - static_cast<size_t>(layer.x)),
+        align(layer.height, window.height - static_cast<size_t>(layer.y))
+    };
+    if ((size.width != ovl.buffer.width() ||
+         size.height != ovl.buffer.height()) &&
+        !ovl.buffer.realloc(wl.shm, size.width, size.height)) {
+        return nullptr;
+    }
+
+    {
+        const std::scoped_lock lock(ovl_mutex);
+        ovl.visible = true;
+        ovl.size = size;
+        if (ovl.pos.x != layer.x || ovl.pos.y != layer.y) {
+            ovl.pos = { .x = layer.x, .y = layer.y };
+            ovl.moved = true;
+        }
+    }
+
+    Pixmap* pm = ovl.buffer.lock();
+    if (pm) {
+        pm->fill({ 0, 0, pm->width(), pm->height() }, argb_t {});
+    }
+    return pm;
+}
+
+void UiWayland::commit_overlay(const size_t index)
+{
+    assert(index < overlays.size());
+
+    // layer is small and redrawn entirely
+    WaylandBuffer& buffer = overlays[index].buffer;
+    buffer.unlock({ Rectangle(0, 0, buffer.width(), buffer.height()) });
+    flush_event.set();
+}
+
+void UiWayland::create_overlays()
+{
+    if (!wl.subcompositor) {
+        return; // text will be drawn on the window surface
+    }
+
+    for (Overlay& ovl : overlays) {
+        ovl.surface = wl_compositor_create_surface(wl.compositor);
+        if (ovl.surface) {
+            ovl.subsurface = wl_subcompositor_get_subsurface(
+                wl.subcompositor, ovl.surface, wl.surface);
+        }
+        if (!ovl.subsurface) {
+            // all or nothing: text can't be split between surfaces
+            for (Overlay& it : overlays) {
+                it.viewport.free();
+                it.subsurface.free();
+                it.surface.free();
+            }
+            return;
+        }
+
+        // layer is committed independently from the window surface
+        wl_subsurface_set_desync(ovl.subsurface);
+
+        // pass all input events to the window surface
+        wl_region* region = wl_compositor_create_region(wl.compositor);
+        wl_surface_set_input_region(ovl.surface, region);
+        wl_region_destroy(region);
+
+        if (wl.viewporter) {
+            ovl.viewport =
+                wp_viewporter_get_viewport(wl.viewporter, ovl.surface);
+        }
+    }
+}
+
+bool UiWayland::flush_overlays()
+{
+    // surface coordinates are logical, buffers are in physical pixels
+    const auto logical = [this](const ssize_t value) {
+        return static_cast<int32_t>(value * FRACTION_SCALE_DEN / scale);
+    };
+
+    bool moved = false;
+
+    for (Overlay& ovl : overlays) {
+        if (!ovl.subsurface) {
+            continue;
+        }
+
+        bool visible;
+        {
+            const std::scoped_lock lock(ovl_mutex);
+            visible = ovl.visible;
+        }
+
+        if (!visible) {
+            if (ovl.attached) {
+                wl_surface_attach(ovl.surface, nullptr, 0, 0);
+                wl_surface_commit(ovl.surface);
+                ovl.attached = false;
+            }
+            continue;
+        }
+
+        std::vector<Rectangle> damage;
+        wl_buffer* buffer = ovl.buffer.flush(damage);
+        if (!buffer) {
+            continue;
+        }
+
+        {
+            const std::scoped_lock lock(ovl_mutex);
+            if (ovl.moved || ovl.scale != scale) {
+                ovl.moved = false;
+                ovl.scale = scale;
+                // applied on the next commit of the parent surface
+                wl_subsurface_set_position(ovl.subsurface, logical(ovl.pos.x),
+                                           logical(ovl.pos.y));
+                moved = true;
+            }
+            if (ovl.viewport) {
+                wp_viewport_set_destination(
+                    ovl.viewport,
+                    std::max(1, logical(static_cast<ssize_t>(ovl.size.width))),
+                    std::max(1,
+                             logical(static_cast<ssize_t>(ovl.size.height))));
+            }
+        }
+        wl_surface_attach(ovl.surface, buffer, 0, 0);
+        for (const Rectangle& it : damage) {
+            wl_surface_damage_buffer(ovl.surface, it.x, it.y, it.width,
+                                     it.height);
+        }
+        wl_surface_commit(ovl.surface);
+        ovl.attached = true;
+    }
+
+    return moved;
+}
+
+void UiWayland::flush()
+{
+    // desynchronized layers are not bound to the window frames, text updates
+    // are rare and the pool of buffers limits the rate
+    if (flush_overlays()) {
+        wl_surface_commit(wl.surface); // apply new positions of the layers
+    }
+
+    // commit no more than one frame per compositor frame, the rest of
+    // updates are accumulated in the window buffer
+    if (!frame_ready) {
+        return;
+    }
+
+    std::vector<Rectangle> damage;
+    wl_buffer* buffer = wnd_buffer.flush(damage);
+    if (!buffer) {
+        return;
+    }
+
+    if (!wl.callback) {
+        wl.callback = wl_surface_frame(wl.surface);
+        wl_callback_add_listener(wl.callback, &WaylandHandler::frame_listener,
+                                 this);
+    }
+
+    wl_surface_attach(wl.surface, buffer, 0, 0);
+    for (const Rectangle& it : damage) {
+        wl_surface_damage_buffer(wl.surface, it.x, it.y, it.width, it.height);
+    }
+    wl_surface_commit(wl.surface);
+
+    frame_ready = false;
 }
@@ -18,6 +18,7 @@
 #include <xdg-decoration-unstable-v1-client-protocol.h>
 #include <xdg-shell-client-protocol.h>
 
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <mutex>
@@ -87,7 +88,12 @@ struct WaylandDisplay : public WaylandObject<wl_display> {
         }                                                                   \
     }
 
-/** Wayland window buffer. */
+/**
+ * Wayland window buffer.
+ * The frame is rendered to a local pixmap, then its changed areas are copied
+ * to one of the shared memory buffers released by the compositor, so the
+ * next frame is rendered while the compositor still holds the previous one.
+ */
 struct WaylandBuffer {
     ~WaylandBuffer();
 
@@ -106,14 +112,18 @@ struct WaylandBuffer {
     Pixmap* lock();
 
     /**
-     * Unlock and wait rendering to finish.
+     * Unlock after rendering.
+     * @param damage array of updated areas
      */
-    void unlock();
+    void unlock(const std::vector<Rectangle>& damage);
 
     /**
-     * Notify about finishing draw.
+     * Copy the last rendered frame to a free shared memory buffer.
+     * @param damage output array of areas updated since the last flush
+     * @return wayland buffer to attach or nullptr if there is nothing to
+     *         flush or all shared buffers are held by the compositor
      */
-    void draw_complete();
+    wl_buffer* flush(std::vector<Rectangle>& damage);
 
     /**
      * Get buffer width.
@@ -127,23 +137,45 @@ struct WaylandBuffer {
      */
     [[nodiscard]] size_t height() const { return pm.height(); }
 
+private:
+    /** Number of shared memory buffers. */
+    static constexpr size_t POOL_SIZE = 3;
+    /** Max number of damaged areas reported to the compositor. */
+    static constexpr size_t MAX_DAMAGE = 16;
+
+    /** Shared memory buffer. */
+    struct Shared {
+        wl_buffer* buffer = nullptr;  ///< Wayland buffer
+        Pixmap pm;                    ///< Pixmap attached to the buffer
+        std::vector<Rectangle> stale; ///< Areas outdated by later frames
+        bool busy = false;            ///< Buffer is held by the compositor
+    };
+
     /**
-     * Get wayland buffer object.
-     * @return wayland buffer
+     * Create shared memory buffer.
+     * @param shared buffer to create
+     * @return true if buffer was created
      */
-    wl_buffer* get() { return buffer; }
+    bool create(Shared& shared);
+
+    /**
+     * Destroy shared memory buffer.
+     * @param shared buffer to destroy
+     */
+    static void destroy(Shared& shared);
 
-private:
     /**
-     * Destroy buffers.
+     * Buffer release handler.
+     * @param data pointer to the shared buffer
      */
-    void destroy();
+    static void on_release(void* data, wl_buffer*);
 
 private:
-    std::atomic<bool> drawn = true; ///< Frame draw complete flag
-    std::mutex mutex;               ///< Buffer lock
-    wl_buffer* buffer = nullptr;    ///< Wayland buffer
-    Pixmap pm;                      ///< Pixmap attached to the buffer
+    std::mutex mutex;                   ///< Buffer lock
+    wl_shm* shm = nullptr;              ///< Wayland shared memory handle
+    Pixmap pm;                          ///< Rendered frame
+    std::vector<Rectangle> pending;     ///< Areas updated since last flush
+    std::array<Shared, POOL_SIZE> pool; ///< Shared memory buffers
 };
 
 /** Wayland based user interface. */
@@ -169,8 +201,12 @@ public:
     Size get_window_size() override;
     void set_window_size(const Size& size) override;
     Point get_mouse() override;
+    [[nodiscard]] bool frame_pending() const override;
     Pixmap* lock_surface() override;
-    void commit_surface() override;
+    void commit_surface(const std::vector<Rectangle>& damage) override;
+    [[nodiscard]] bool has_overlay() const override;
+    Pixmap* lock_overlay(const size_t index, const Rectangle& area) override;
+    void commit_overlay(const size_t index) override;
 
 private:
     // Fractional scale denominator (Wayland constant)
@@ -185,6 +221,7 @@ private:
         WaylandDisplay display;
         WLOBJ_DECLARE(wl_registry) registry;
         WLOBJ_DECLARE(wl_compositor) compositor;
+        WLOBJ_DECLARE(wl_subcompositor) subcompositor;
         WLOBJ_DECLARE(wl_surface) surface;
         WLOBJ_DECLARE(wl_callback) callback;
         WLOBJ_DECLARE(wl_pointer) pointer;
@@ -213,8 +250,51 @@ private:
         WLOBJ_DECLARE(ext_idle_notification_v1) idle;
     } wl;
 
+    /**
+     * Overlay layer: transparent subsurface above the window.
+     * The layer is sized to its content (a text block), so its buffers are
+     * small and the window surface can still be scanned out directly.
+     */
+    struct Overlay {
+        WLOBJ_DECLARE(wl_surface) surface;
+        WLOBJ_DECLARE(wl_subsurface) subsurface;
+        WLOBJ_DECLARE(wp_viewport) viewport;
+        WaylandBuffer buffer; ///< Layer buffer
+
+        // state set by the main thread, protected by ovl_mutex
+        Point pos;            ///< Position on the window (buffer pixels)
+        Size size;            ///< Buffer size
+        bool visible = false; ///< Layer is shown
+        bool moved = false;   ///< Position is not applied yet
+
+        // state of the Wayland thread
+        bool attached = false; ///< Buffer is attached to the surface
+        uint32_t scale = 0;    ///< Scale factor of the applied position
+    };
+
+    /**
+     * Create overlay subsurfaces above the window surface.
+     */
+    void create_overlays();
+
+    /**
+     * Attach the last rendered frame to the surface (Wayland thread).
+     */
+    void flush();
+
+    /**
+     * Attach the last rendered overlay layers (Wayland thread).
+     * @return true if position of any layer was changed
+     */
+    bool flush_overlays();
+
     WaylandBuffer wnd_buffer; ///< Window buffer
 
+    std::array<Overlay, MAX_OVERLAYS> overlays; ///< Overlay layers
+    std::mutex ovl_mutex;                       ///< Overlay state lock
+
+    std::atomic<bool> frame_ready = true; ///< Compositor waits for new frame
+
     uint32_t scale = FRACTION_SCALE_DEN; ///< Window scale factor (WL format)
 
     Xkb xkb; ///< X keyboard extension
@@ -16,9 +16,27 @@
 #include <format>
 #include <utility>
 
+namespace {
+
 /** Max scale factor. */
 constexpr double MAX_SCALE = 100.0;
 
+/** Delay before loading the image after key auto-repeat is stopped (ms). */
+constexpr size_t SKIP_DELAY = 200;
+
+/**
+ * Check if direction is forward.
+ * @param dir direction to check
+ * @return true if direction is forward
+ */
+bool is_forward(const ImageList::Dir dir)
+{
+    return dir != ImageList::Dir::First && dir != ImageList::Dir::Prev &&
+        dir != ImageList::Dir::PrevParent;
+}
+
+} // anonymous namespace
+
 Viewer& Viewer::self()
 {
     static Viewer singleton;
@@ -28,6 +46,7 @@ Viewer& Viewer::self()
 Viewer::Viewer()
     : auto_center(Defaults::viewer::auto_center)
     , imagelist_loop(Defaults::viewer::imagelist_loop)
+    , skip_on_repeat(Defaults::viewer::skip_on_repeat)
     , default_scale(Defaults::viewer::scale)
     , default_pos(Defaults::viewer::position)
     , scale(1.0)
@@ -60,17 +79,34 @@ Viewer::Viewer()
 
 bool Viewer::open(const ImageList::Dir dir)
 {
+    if (key_repeat && skip_on_repeat && image) {
+        return skip(dir);
+    }
+
     ImageList& il = ImageList::self();
 
     ImageEntryPtr next;
     if (image) {
-        next = il.get(image->entry, dir);
+        next = il.get(skipped ? skipped : image->entry, dir);
     } else {
         next = il.get(nullptr, ImageList::Dir::First);
     }
 
-    const bool forward = dir != ImageList::Dir::First &&
-        dir != ImageList::Dir::Prev && dir != ImageList::Dir::PrevParent;
+    const bool skipping = !!skipped;
+    skipped = nullptr;
+    skip_timer.reset(0, 0);
+
+    const bool loaded = load(next, is_forward(dir));
+    if (!loaded && skipping) {
+        update_text(TextUpdate::All); // restore info about current image
+    }
+
+    return loaded;
+}
+
+bool Viewer::load(ImageEntryPtr next, const bool forward)
+{
+    ImageList& il = ImageList::self();
 
     while (true) {
         if (!next && imagelist_loop) {
@@ -387,6 +423,10 @@ void Viewer::bind_image_drag(const InputMouse& input)
 
 void Viewer::initialize()
 {
+    Application::self().add_fdpoll(skip_timer, [this]() {
+        skip_finish();
+    });
+
     Application::self().add_fdpoll(animation_timer, [this]() {
         size_t index = frame_index + 1;
         if (index >= image->frames.size()) {
@@ -415,6 +455,9 @@ void Viewer::deactivate()
 {
     preloader_stop();
 
+    skipped = nullptr;
+    skip_timer.reset(0, 0);
+
     // restore cursor and content type
     Ui* ui = Application::get_ui();
     ui->set_ctype(Ui::ContentType::Static);
@@ -423,6 +466,9 @@ void Viewer::deactivate()
 
 ImageEntryPtr Viewer::get_current()
 {
+    if (skipped) {
+        return skipped;
+    }
     return image ? image->entry : nullptr;
 }
 
@@ -443,12 +489,12 @@ bool Viewer::set_current(const ImageEntryPtr& entry)
         new_image = image_pool.preload.get(entry);
         if (new_image) {
             Log::verbose("Got image {} from preloading cache",
-                         entry->path.filename().string());
+                         entry->path().filename().string());
         } else {
             new_image = image_pool.history.get(entry);
             if (new_image) {
                 Log::verbose("Got image {} from history cache",
-                             entry->path.filename().string());
+                             entry->path().filename().string());
             }
         }
     }
@@ -469,12 +515,14 @@ void Viewer::window_resize(const Size& wnd)
     reset();
 }
 
-void Viewer::window_redraw(Pixmap& wnd)
+std::vector<Rectangle> Viewer::window_redraw(Pixmap& wnd)
 {
+    const Rectangle wnd_area { 0, 0, wnd.width(), wnd.height() };
+
     if (!image) {
         const argb_t* bkg = std::get_if<argb_t>(&window_bkg);
         draw_empty(wnd, bkg ? *bkg : Defaults::viewer::window_bkg);
-        return;
+        return { wnd_area };
     }
 
     const Pixmap& pm = image->frames[frame_index].pm;
@@ -522,6 +570,8 @@ void Viewer::window_redraw(Pixmap& wnd)
             static_cast<ssize_t>(Resource::mark.height()) - margin;
         wnd.mask(Resource::mark, { .x = x, .y = y }, mark_color);
     }
+
+    return { wnd_area };
 }
 
 void Viewer::handle_mmove(const InputMouse& input, const Point&,
@@ -570,6 +620,13 @@ void Viewer::handle_imagelist(const ImageListEvent event,
             }
             break;
         case ImageListEvent::Remove:
+            if (skipped && skipped->removed) {
+                skipped = nullptr;
+                skip_timer.reset(0, 0);
+                if (image && !image->entry->removed) {
+                    update_text(TextUpdate::All);
+                }
+            }
             if (image && image->entry->removed) {
                 reload();
             }
@@ -633,6 +690,71 @@ void Viewer::set_image(const ImagePtr& img)
     update_text(TextUpdate::All);
 }
 
+bool Viewer::skip(const ImageList::Dir dir)
+{
+    assert(image);
+
+    ImageList& il = ImageList::self();
+    const ImageEntryPtr from = skipped ? skipped : image->entry;
+
+    ImageEntryPtr next = il.get(from, dir);
+    if (!next && imagelist_loop) {
+        // start new loop, the random order is reshuffled on real opening
+        next = il.get(nullptr,
+                      is_forward(dir) ? ImageList::Dir::First
+                                      : ImageList::Dir::Last);
+    }
+    if (!next || next == from) {
+        return false;
+    }
+
+    skip_forward = is_forward(dir);
+
+    if (next == image->entry) {
+        // returned to the currently shown image
+        skipped = nullptr;
+        skip_timer.reset(0, 0);
+        update_text(TextUpdate::All);
+        return true;
+    }
+
+    // already decoded image is cheap to show, take it from the cache at once
+    // so the preloader can't evict it in between
+    ImagePtr cached;
+    {
+        const std::scoped_lock lock(image_pool.mutex);
+        cached = image_pool.preload.get(next);
+        if (!cached) {
+            cached = image_pool.history.get(next);
+        }
+    }
+    if (cached) {
+        skipped = nullptr;
+        skip_timer.reset(0, 0);
+        set_image(cached);
+        return true;
+    }
+
+    // show only file info, the image is loaded when the key is released
+    skipped = next;
+    skip_timer.reset(SKIP_DELAY, 0);
+    Text::self().reset(next);
+
+    return true;
+}
+
+void Viewer::skip_finish()
+{
+    skip_timer.reset(0, 0);
+
+    const ImageEntryPtr entry = skipped;
+    skipped = nullptr;
+
+    if (entry && image && !load(entry, skip_forward)) {
+        update_text(TextUpdate::All); // restore info about current image
+    }
+}
+
 void Viewer::set_frame(const size_t index)
 {
     assert(is_active());
@@ -779,7 +901,7 @@ void Viewer::preloader_work()
             il.remove(next_entry);
         } else {
             Log::verbose("Put image {} to cache",
-                         next_entry->path.filename().string());
+                         next_entry->path().filename().string());
             const std::scoped_lock lock(image_pool.mutex);
             image_pool.preload.put(next_image);
             last_entry = next_image->entry;
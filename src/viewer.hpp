@@ -215,7 +215,7 @@ public:
     ImageEntryPtr get_current() override;
     bool set_current(const ImageEntryPtr& entry) override;
     void window_resize(const Size& wnd) override;
-    void window_redraw(Pixmap& wnd) override;
+    std::vector<Rectangle> window_redraw(Pixmap& wnd) override;
     void handle_mmove(const InputMouse& input, const Point& pos,
                       const Point& delta) override;
     void handle_pinch(const double scale_delta) override;
@@ -242,6 +242,26 @@ private:
      */
     void update_text(const TextUpdate what) const;
 
+    /**
+     * Open image starting from specified entry, broken files are removed.
+     * @param next entry to open
+     * @param forward direction to search for the next loadable entry
+     * @return true if image was loaded
+     */
+    bool load(ImageEntryPtr next, const bool forward);
+
+    /**
+     * Move to the next entry without decoding it (key auto-repeat).
+     * @param dir next entry direction
+     * @return true if current entry was changed
+     */
+    bool skip(const ImageList::Dir dir);
+
+    /**
+     * Load the image the skipping stopped on.
+     */
+    void skip_finish();
+
     /**
      * Fix up image position.
      */
@@ -302,6 +322,7 @@ private:
 public:
     bool auto_center;    ///< Enable automatic image centering
     bool imagelist_loop; ///< Flag to loop image list
+    bool skip_on_repeat; ///< Don't decode images while key is auto-repeated
 
     std::variant<double, Scale> default_scale; ///< Default image scale
     Position default_pos;                      ///< Default image position
@@ -327,6 +348,11 @@ protected:
 
     InputMouse drag; ///< Mouse state for dragging an image across the canvas
 
+    // Skipping images on key auto-repeat
+    ImageEntryPtr skipped;    ///< Entry to load, nullptr if not skipping
+    bool skip_forward = true; ///< Direction of skipping
+    FdTimer skip_timer;       ///< Timer to load the last skipped entry
+
     /** Image pool. */
     struct ImagePool {
         Cache preload;          ///< Preloaded images (read ahead)
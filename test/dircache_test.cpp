@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: MIT
+// Copyright (C) 2026 Artem Senichev <artemsen@gmail.com>
+
+#include "dircache.hpp"
+
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+
+#include <fstream>
+
+namespace {
+
+// Create temporary cache file path
+std::filesystem::path cache_file(const char* name)
+{
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove(path);
+    return path;
+}
+
+// Create listing with specified number of files
+DirCache::Listing make_listing(const size_t files)
+{
+    DirCache::Listing listing;
+    for (size_t i = 0; i < files; ++i) {
+        listing.files.push_back({ .name = "file_" + std::to_string(i),
+                                  .mtime = static_cast<std::time_t>(i),
+                                  .size = i * 10 });
+    }
+    listing.dirs.emplace_back("subdir");
+    listing.attrs = STATX_MTIME;
+    return listing;
+}
+
+} // anonymous namespace
+
+TEST(DirCacheTest, PutGet)
+{
+    const std::filesystem::path path = cache_file("swayimg_dircache_putget");
+    const DirCache::Stamp stamp { .sec = 123, .nsec = 456 };
+
+    DirCache cache;
+    cache.open(path);
+
+    DirCache::Listing listing;
+    EXPECT_FALSE(cache.get("/dir", stamp, listing));
+
+    cache.put("/dir", stamp, make_listing(3));
+    ASSERT_TRUE(cache.get("/dir", stamp, listing));
+    ASSERT_EQ(listing.files.size(), 3UL);
+    EXPECT_EQ(listing.files[2].name, "file_2");
+    EXPECT_EQ(listing.files[2].size, 20UL);
+    ASSERT_EQ(listing.dirs.size(), 1UL);
+
+    // directory was changed
+    EXPECT_FALSE(cache.get("/dir", { .sec = 123, .nsec = 457 }, listing));
+}
+
+TEST(DirCacheTest, SaveLoad)
+{
+    const std::filesystem::path path = cache_file("swayimg_dircache_save");
+    const DirCache::Stamp stamp { .sec = 1, .nsec = 2 };
+
+    {
+        DirCache cache;
+        cache.open(path);
+        cache.put("/a", stamp, make_listing(5));
+        cache.put("/b", stamp, make_listing(0));
+        cache.save();
+    }
+
+    DirCache cache;
+    cache.open(path);
+    DirCache::Listing listing;
+    ASSERT_TRUE(cache.get("/a", stamp, listing));
+    ASSERT_EQ(listing.files.size(), 5UL);
+    EXPECT_EQ(listing.files[4].name, "file_4");
+    EXPECT_EQ(listing.files[4].mtime, 4);
+    EXPECT_EQ(listing.files[4].size, 40UL);
+    EXPECT_EQ(listing.dirs[0], "subdir");
+    EXPECT_EQ(listing.attrs, static_cast<uint32_t>(STATX_MTIME));
+    ASSERT_TRUE(cache.get("/b", stamp, listing));
+    EXPECT_TRUE(listing.files.empty());
+
+    std::filesystem::remove(path);
+}
+
+TEST(DirCacheTest, Corrupted)
+{
+    const std::filesystem::path path = cache_file("swayimg_dircache_bad");
+    const DirCache::Stamp stamp { .sec = 1, .nsec = 2 };
+
+    {
+        DirCache cache;
+        cache.open(path);
+        cache.put("/a", stamp, make_listing(5));
+        cache.save();
+    }
+
+    // truncate the file
+    const uintmax_t size = std::filesystem::file_size(path);
+    std::filesystem::resize_file(path, size - 1);
+
+    DirCache cache;
+    cache.open(path);
+    DirCache::Listing listing;
+    EXPECT_FALSE(cache.get("/a", stamp, listing));
+
+    std::filesystem::remove(path);
+}
+
+TEST(DirCacheTest, Prune)
+{
+    const std::filesystem::path path = cache_file("swayimg_dircache_prune");
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path removed = tmp / "swayimg_dircache_removed";
+    const DirCache::Stamp stamp { .sec = 1, .nsec = 2 };
+    std::filesystem::create_directories(removed);
+
+    {
+        DirCache cache;
+        cache.open(path);
+        cache.put(removed, stamp, make_listing(1));
+        cache.put(tmp, stamp, make_listing(1));
+        cache.save();
+    }
+
+    // not visited directory is removed only if it doesn't exist
+    std::filesystem::remove(removed);
+    {
+        DirCache cache;
+        cache.open(path);
+        cache.put("/visited", stamp, make_listing(1));
+        cache.save();
+    }
+
+    DirCache cache;
+    cache.open(path);
+    DirCache::Listing listing;
+    EXPECT_FALSE(cache.get(removed, stamp, listing));
+    EXPECT_TRUE(cache.get(tmp, stamp, listing));
+    EXPECT_TRUE(cache.get("/visited", stamp, listing));
+
+    std::filesystem::remove(path);
+}
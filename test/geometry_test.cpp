@@ -201,3 +201,17 @@ TEST(RectangleTest, Intersection)
         Rectangle { 0, 0, 10, 10 }.intersect({ 10, 0, 5, 5 });
     EXPECT_FALSE(edge);
 }
+
+TEST(RectangleTest, Unite)
+{
+    const Rectangle box = Rectangle { -2, 3, 4, 5 }.unite({ 5, 0, 1, 1 });
+    EXPECT_EQ(box.x, -2);
+    EXPECT_EQ(box.y, 0);
+    EXPECT_EQ(box.width, 8UL);
+    EXPECT_EQ(box.height, 8UL);
+
+    // invalid rectangle is ignored
+    const Rectangle valid { 1, 2, 3, 4 };
+    EXPECT_EQ(valid.unite({}), valid);
+    EXPECT_EQ(Rectangle().unite(valid), valid);
+}
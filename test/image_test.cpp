@@ -11,7 +11,7 @@ namespace {
 ImagePtr load_image(const char* path)
 {
     const ImageEntryPtr entry = std::make_shared<ImageEntry>();
-    entry->path = path;
+    entry->set_path(path);
     return FormatFactory::self().load(entry);
 }
 } // anonymous namespace
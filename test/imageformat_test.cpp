@@ -53,7 +53,7 @@ TEST(ImageFormatTest, PreviewInvalidData)
     const FormatFactory& factory = FormatFactory::self();
 
     const ImageEntryPtr entry = std::make_shared<ImageEntry>();
-    entry->path = "/nonexistent/image.jpg";
+    entry->set_path("/nonexistent/image.jpg");
 
     const Pixmap preview = factory.preview(entry, 100, false);
     EXPECT_FALSE(preview);
@@ -64,7 +64,7 @@ TEST(ImageFormatTest, PreviewFromValidImageEntry)
     const FormatFactory& factory = FormatFactory::self();
 
     const ImageEntryPtr entry = std::make_shared<ImageEntry>();
-    entry->path = TEST_DATA_DIR "/image.bmp";
+    entry->set_path(TEST_DATA_DIR "/image.bmp");
 
     const Pixmap preview = factory.preview(entry, 64, false);
     ASSERT_TRUE(preview);
@@ -76,7 +76,7 @@ TEST(ImageFormatTest, LoadNonExistentFile)
     const FormatFactory& factory = FormatFactory::self();
 
     const ImageEntryPtr entry = std::make_shared<ImageEntry>();
-    entry->path = "/tmp/nonexistent_test_image.xyz";
+    entry->set_path("/tmp/nonexistent_test_image.xyz");
 
     const ImagePtr image = factory.load(entry);
     EXPECT_EQ(image, nullptr);
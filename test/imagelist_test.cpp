@@ -6,7 +6,9 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
 #include <format>
+#include <fstream>
 
 // NOLINTNEXTLINE(bugprone-throwing-static-initialization)
 static const std::filesystem::path IMGLIST_TEST_DIR =
@@ -24,10 +26,10 @@ CheckImageLists(const std::vector<ImageEntryPtr>& real,
     }
 
     for (size_t i = 0; i < real.size(); ++i) {
-        if (real[i]->path != expect[i]) {
+        if (real[i]->path() != expect[i]) {
             return ::testing::AssertionFailure()
                 << "Path " << i << " doesn't match: expected " << expect[i]
-                << ", but got " << real[i]->path;
+                << ", but got " << real[i]->path();
         }
     }
 
@@ -42,7 +44,7 @@ std::string to_string(const std::vector<ImageEntryPtr>& real,
     dump += "--+--------------+--------------";
     for (size_t i = 0; i < std::max(real.size(), expect.size()); ++i) {
         const std::string rpath =
-            i < real.size() ? real[i]->path.string() : "NULL";
+            i < real.size() ? real[i]->path().string() : "NULL";
         const std::string epath =
             i < expect.size() ? expect[i].string() : "NULL";
         dump += std::format("\n{} | {:12} | {}", i, rpath, epath);
@@ -187,6 +189,355 @@ TEST(ImageListTest, RecursiveOn)
     EXPECT_ILEQ(il.get_all(), expected);
 }
 
+TEST(ImageListTest, RecursiveTree)
+{
+    const std::filesystem::path root =
+        std::filesystem::temp_directory_path() / "swayimg_imagelist_tree";
+    std::filesystem::remove_all(root);
+
+    // 10 directories with 10 nested directories in each, 2 files everywhere
+    std::vector<std::filesystem::path> expected;
+    for (size_t i = 0; i < 10; ++i) {
+        const std::filesystem::path dir = root / std::format("d{}", i);
+        for (size_t j = 0; j < 10; ++j) {
+            const std::filesystem::path sub = dir / std::format("s{}", j);
+            std::filesystem::create_directories(sub);
+            for (const auto& it : { dir, sub }) {
+                for (size_t k = 0; k < 2; ++k) {
+                    const std::filesystem::path file =
+                        it / std::format("f{}", k);
+                    if (!std::filesystem::exists(file)) {
+                        std::ofstream(file) << k;
+                        expected.push_back(file);
+                    }
+                }
+            }
+        }
+    }
+
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = true;
+    il.set_order(ImageList::Order::Alpha);
+    const auto added = il.add({ root });
+    std::filesystem::remove_all(root);
+
+    std::ranges::sort(expected, [](const auto& l, const auto& r) {
+        const auto lp = l.parent_path();
+        const auto rp = r.parent_path();
+        return lp == rp ? l < r : lp.string() < rp.string();
+    });
+    EXPECT_EQ(added.size(), expected.size());
+    EXPECT_ILEQ(il.get_all(), expected);
+}
+
+TEST(ImageListTest, DirCache)
+{
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path root = tmp / "swayimg_imagelist_cache";
+    const std::filesystem::path cache = tmp / "swayimg_imagelist_cache.dirs";
+    std::filesystem::remove_all(root);
+    std::filesystem::remove(cache);
+
+    std::filesystem::create_directories(root / "sub");
+    std::ofstream(root / "a") << 0;
+    std::ofstream(root / "sub" / "b") << 0;
+
+    const auto count = [&]() {
+        ImageList il;
+        il.adjacent = false;
+        il.recursive = true;
+        il.fsmon = false;
+        il.cache = true;
+        il.cache_path = cache;
+        const size_t size = il.add({ root }).size();
+        il.save_cache();
+        return size;
+    };
+
+    EXPECT_EQ(count(), 2UL);
+    EXPECT_TRUE(std::filesystem::exists(cache));
+
+    // directory with the same modification time is not read
+    const auto mtime = std::filesystem::last_write_time(root / "sub");
+    std::ofstream(root / "sub" / "c") << 0;
+    std::filesystem::last_write_time(root / "sub", mtime);
+    EXPECT_EQ(count(), 2UL);
+
+    // changed directory is read again
+    std::filesystem::last_write_time(root / "sub",
+                                     mtime + std::chrono::seconds(1));
+    EXPECT_EQ(count(), 3UL);
+
+    std::filesystem::remove_all(root);
+    std::filesystem::remove(cache);
+}
+
+TEST(ImageListTest, DirCacheAttributes)
+{
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path root = tmp / "swayimg_imagelist_cattr";
+    const std::filesystem::path cache = tmp / "swayimg_imagelist_cattr.dirs";
+    std::filesystem::remove_all(root);
+    std::filesystem::remove(cache);
+    std::filesystem::create_directories(root);
+    std::ofstream(root / "a") << 0;
+
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = false;
+    il.fsmon = false;
+    il.cache = true;
+    il.cache_path = cache;
+
+    const auto scan = [&](const ImageList::Order order) {
+        il.set_order(order);
+        std::vector<ImageList::File> files;
+        il.scan({ root }, il.get_scan_options(),
+                [&files](ImageList::Batch&& batch) {
+                    files.insert(files.end(), batch.files.begin(),
+                                 batch.files.end());
+                    return true;
+                });
+        return files;
+    };
+
+    // cached listing without modification time is not used for mtime order
+    std::vector<ImageList::File> files = scan(ImageList::Order::Alpha);
+    ASSERT_EQ(files.size(), 1UL);
+    EXPECT_EQ(files[0].mtime, 0);
+    files = scan(ImageList::Order::Mtime);
+    ASSERT_EQ(files.size(), 1UL);
+    EXPECT_NE(files[0].mtime, 0);
+
+    // listing with more attributes than required is used
+    files = scan(ImageList::Order::Alpha);
+    ASSERT_EQ(files.size(), 1UL);
+    EXPECT_NE(files[0].mtime, 0);
+
+    std::filesystem::remove_all(root);
+    std::filesystem::remove(cache);
+}
+
+TEST(ImageListTest, Extensions)
+{
+    const std::filesystem::path root =
+        std::filesystem::temp_directory_path() / "swayimg_imagelist_ext";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    for (const char* name : { "a.jpg", "b.JPG", "c.png", "d.xmp", "e" }) {
+        std::ofstream(root / name) << 0;
+    }
+
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = false;
+    il.fsmon = false;
+    il.set_order(ImageList::Order::Alpha);
+    il.set_extensions({ "jpg", ".Png" });
+
+    const std::vector<std::filesystem::path> expected = {
+        root / "a.jpg",
+        root / "b.JPG",
+        root / "c.png",
+    };
+    EXPECT_ILEQ(il.add({ root }), expected);
+    EXPECT_TRUE(il.add({ root / "d.xmp" }).empty());
+
+    // filter disabled
+    il.set_extensions({});
+    EXPECT_EQ(il.add({ root }).size(), 2UL);
+
+    std::filesystem::remove_all(root);
+}
+
+TEST(ImageListTest, ScanBatches)
+{
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = true;
+    il.fsmon = false;
+
+    // settings are captured before scanning
+    const ImageList::ScanOptions options = il.get_scan_options();
+    il.recursive = false;
+
+    // scanning doesn't modify the list
+    std::vector<ImageList::Batch> batches;
+    il.scan({ IMGLIST_TEST_DIR }, options,
+            [&batches](ImageList::Batch&& batch) {
+                batches.emplace_back(std::move(batch));
+                return true;
+            });
+    EXPECT_EQ(il.size(), 0UL);
+    ASSERT_EQ(batches.size(), 2UL); // top directory and subdir
+    EXPECT_EQ(batches[0].files.size(), 2UL);
+    EXPECT_EQ(batches[1].files.size(), 2UL);
+
+    for (const auto& it : batches) {
+        const ImageList::EntriesArray added = il.add(it);
+        EXPECT_EQ(added.size(), 2UL);
+        EXPECT_LT(added[0]->index(), added[1]->index());
+    }
+    EXPECT_EQ(il.size(), 4UL);
+    EXPECT_TRUE(il.add(batches[0]).empty()); // duplicates
+
+    // stop scanning
+    size_t calls = 0;
+    il.scan({ IMGLIST_TEST_DIR, IMGLIST_TEST_DIR }, options,
+            [&calls](ImageList::Batch&&) {
+                ++calls;
+                return false;
+            });
+    EXPECT_EQ(calls, 1UL);
+}
+
+TEST(ImageListTest, Incremental)
+{
+    constexpr size_t total = 2000;
+
+    ImageList il;
+    il.set_order(ImageList::Order::Numeric);
+
+    // each special source is added by separate batch
+    std::vector<std::filesystem::path> sources;
+    for (size_t i = 0; i < total; ++i) {
+        sources.emplace_back("exec://" + std::to_string((i * 7919) % total));
+    }
+    il.add(sources);
+    ASSERT_EQ(il.size(), total);
+
+    const auto check = [&il](const bool reverse = false) {
+        const ImageList::EntriesArray all = il.get_all();
+        for (size_t i = 0; i < all.size(); ++i) {
+            EXPECT_EQ(all[i]->index(), i);
+            if (i) {
+                const std::string prev = all[i - 1]->path().string().substr(7);
+                const std::string curr = all[i]->path().string().substr(7);
+                EXPECT_EQ(std::stoul(prev) < std::stoul(curr), !reverse);
+            }
+        }
+    };
+    check();
+
+    // range crosses groups
+    const ImageList::EntriesArray range = il.get_range(250, 1300);
+    ASSERT_EQ(range.size(), 1051UL);
+    EXPECT_EQ(range.front()->path(), "exec://250");
+    EXPECT_EQ(range.back()->path(), "exec://1300");
+
+    // single removal keeps index of removed entry
+    const ImageEntryPtr removed = il.find("exec://1000");
+    ASSERT_TRUE(removed);
+    il.remove(removed);
+    EXPECT_EQ(removed->index(), 1000UL);
+    EXPECT_EQ(il.get(removed, ImageList::Dir::Next)->path(), "exec://1001");
+    check();
+
+    // bulk removal
+    std::vector<std::filesystem::path> remove;
+    for (size_t i = 0; i < total; i += 2) {
+        remove.emplace_back("exec://" + std::to_string(i));
+    }
+    EXPECT_EQ(il.remove(remove).size(), total / 2 - 1);
+    EXPECT_EQ(il.size(), total / 2);
+    check();
+
+    il.set_reverse(true);
+    check(true);
+    EXPECT_EQ(il.get(nullptr, ImageList::Dir::First)->path(), "exec://1999");
+}
+
+TEST(ImageListTest, SharedDir)
+{
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = false;
+    il.add({ IMGLIST_TEST_DIR, "exec://a/b" });
+
+    const ImageList::EntriesArray all = il.get_all();
+    ASSERT_EQ(all.size(), 3UL);
+    EXPECT_EQ(all[0]->dir, all[1]->dir);
+    EXPECT_EQ(all[0]->dir->path, IMGLIST_TEST_DIR);
+    EXPECT_EQ(all[2]->path(), "exec://a/b");
+
+    for (const ImageEntryPtr& entry : all) {
+        EXPECT_EQ(il.find(entry->path()), entry);
+    }
+    EXPECT_FALSE(il.find(IMGLIST_TEST_DIR / "file_"));
+    EXPECT_FALSE(il.find("exec://a/"));
+}
+
+TEST(ImageListTest, LazyStat)
+{
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = false;
+    il.set_order(ImageList::Order::Alpha);
+    il.add({ IMGLIST_TEST_DIR });
+
+    // file attributes are not needed for alphabetical order
+    const auto entries = il.get_all();
+    ASSERT_EQ(entries.size(), 2UL);
+    for (const auto& it : entries) {
+        EXPECT_EQ(it->mtime, 0);
+        EXPECT_EQ(it->size, 0UL);
+    }
+
+    // loaded on demand when sorting requires them
+    il.set_order(ImageList::Order::Size);
+    for (const auto& it : entries) {
+        EXPECT_NE(it->mtime, 0);
+        EXPECT_EQ(it->size, 6UL);
+    }
+}
+
+TEST(ImageListTest, ScanStat)
+{
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = true;
+    il.set_order(ImageList::Order::Mtime);
+    il.add({ IMGLIST_TEST_DIR });
+
+    const auto entries = il.get_all();
+    ASSERT_EQ(entries.size(), 4UL);
+    for (const auto& it : entries) {
+        EXPECT_NE(it->mtime, 0);
+    }
+}
+
+TEST(ImageListTest, Refresh)
+{
+    const std::filesystem::path root =
+        std::filesystem::temp_directory_path() / "swayimg_imagelist_refresh";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    std::ofstream(root / "a") << "1";
+    std::ofstream(root / "b") << "22";
+    std::ofstream(root / "c") << "333";
+
+    ImageList il;
+    il.adjacent = false;
+    il.recursive = false;
+    il.fsmon = false;
+    il.set_order(ImageList::Order::Size);
+    il.add({ root });
+    EXPECT_ILEQ(il.get_all(), std::vector<std::filesystem::path>({
+                                  root / "a", root / "b", root / "c" }));
+
+    // file rewritten in place is moved according to its new size
+    std::ofstream(root / "a") << "4444";
+    const ImageEntryPtr entry = il.find(root / "a");
+    ASSERT_TRUE(entry);
+    il.refresh({ entry });
+    EXPECT_EQ(entry->size, 4UL);
+    EXPECT_ILEQ(il.get_all(), std::vector<std::filesystem::path>({
+                                  root / "b", root / "c", root / "a" }));
+
+    std::filesystem::remove_all(root);
+}
+
 TEST(ImageListTest, SourceOrder)
 {
     ImageList il;
@@ -205,12 +556,15 @@ TEST(ImageListTest, BigNumber)
     ImageList il;
     il.set_order(ImageList::Order::Numeric);
 
+    // numbers that don't fit into 64 bits are still compared by value
     const std::vector<std::filesystem::path> paths = {
-        "exec://712174062970435688724dab6dc3ceb.jpeg",
         "exec://7152b8159cf6a64e8dda2ff3f8ed40f.jpeg",
+        "exec://712174062970435688724dab6dc3ceb.jpeg",
+        "exec://99999999999999999999999999999999.jpeg",
+        "exec://100000000000000000000000000000000.jpeg",
     };
 
-    il.add(paths);
+    il.add({ paths[3], paths[1], paths[2], paths[0] });
     EXPECT_ILEQ(il.get_all(), paths);
 }
 
@@ -355,6 +709,33 @@ TEST(ImageListTest, SortNumericReverse)
     EXPECT_ILEQ(il.get_all(), paths);
 }
 
+TEST(ImageListTest, SortSwitchNumeric)
+{
+    ImageList il;
+    il.set_order(ImageList::Order::Alpha);
+    il.set_reverse(false);
+
+    const std::vector<std::filesystem::path> alpha = {
+        "exec://d10/a10",
+        "exec://d2/a10",
+        "exec://d2/a2",
+    };
+    const std::vector<std::filesystem::path> numeric = {
+        "exec://d2/a2",
+        "exec://d2/a10",
+        "exec://d10/a10",
+    };
+
+    il.add(alpha);
+    EXPECT_ILEQ(il.get_all(), alpha);
+
+    // sort keys must be rebuilt on switching numeric mode
+    il.set_order(ImageList::Order::Numeric);
+    EXPECT_ILEQ(il.get_all(), numeric);
+    il.set_order(ImageList::Order::Alpha);
+    EXPECT_ILEQ(il.get_all(), alpha);
+}
+
 TEST(ImageListTest, SortTime)
 {
     ImageList il;
@@ -369,7 +750,7 @@ TEST(ImageListTest, SortTime)
 
     std::time_t mtime = 1000;
     for (auto& it : il.get_all()) {
-        if (it->path != "exec://2") {
+        if (it->path() != "exec://2") {
             it->mtime = mtime;
         }
         --mtime;
@@ -392,11 +773,11 @@ TEST(ImageListTest, SortSize)
 
     // set sizes after add to trigger re-sort
     for (auto& it : il.get_all()) {
-        if (it->path == "exec://sortsize_a") {
+        if (it->path() == "exec://sortsize_a") {
             it->size = 300;
-        } else if (it->path == "exec://sortsize_b") {
+        } else if (it->path() == "exec://sortsize_b") {
             it->size = 100;
-        } else if (it->path == "exec://sortsize_c") {
+        } else if (it->path() == "exec://sortsize_c") {
             it->size = 200;
         }
     }
@@ -425,7 +806,7 @@ TEST(ImageListTest, SortRandom)
     bool ordered = true;
     for (const auto& it : paths) {
         ASSERT_TRUE(entry);
-        ordered &= entry->path == it;
+        ordered &= entry->path() == it;
         entry = il.get(entry, ImageList::Dir::Next);
     }
 
@@ -443,7 +824,7 @@ TEST(ImageListTest, GetFirst)
 
     const ImageEntryPtr first = il.get(nullptr, ImageList::Dir::First);
     ASSERT_TRUE(first);
-    EXPECT_EQ(first->path, "exec://first");
+    EXPECT_EQ(first->path(), "exec://first");
 }
 
 TEST(ImageListTest, GetLast)
@@ -457,7 +838,7 @@ TEST(ImageListTest, GetLast)
 
     const ImageEntryPtr last = il.get(nullptr, ImageList::Dir::Last);
     ASSERT_TRUE(last);
-    EXPECT_EQ(last->path, "exec://last");
+    EXPECT_EQ(last->path(), "exec://last");
 }
 
 TEST(ImageListTest, GetNext)
@@ -471,7 +852,7 @@ TEST(ImageListTest, GetNext)
 
     const ImageEntryPtr next = il.get(first, ImageList::Dir::Next);
     ASSERT_TRUE(next);
-    EXPECT_EQ(next->path, "exec://last");
+    EXPECT_EQ(next->path(), "exec://last");
 
     EXPECT_FALSE(il.get(next, ImageList::Dir::Next));
 }
@@ -487,7 +868,7 @@ TEST(ImageListTest, GetPrev)
 
     const ImageEntryPtr prev = il.get(last, ImageList::Dir::Prev);
     ASSERT_TRUE(prev);
-    EXPECT_EQ(prev->path, "exec://first");
+    EXPECT_EQ(prev->path(), "exec://first");
 
     EXPECT_FALSE(il.get(prev, ImageList::Dir::Prev));
 }
@@ -509,11 +890,11 @@ TEST(ImageListTest, GetNextParent)
 
     entry = il.get(entry, ImageList::Dir::NextParent);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://b/0");
+    EXPECT_EQ(entry->path(), "exec://b/0");
 
     entry = il.get(entry, ImageList::Dir::NextParent);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://c/0");
+    EXPECT_EQ(entry->path(), "exec://c/0");
 
     entry = il.get(entry, ImageList::Dir::NextParent);
     ASSERT_FALSE(entry);
@@ -536,16 +917,66 @@ TEST(ImageListTest, GetPrevParent)
 
     entry = il.get(entry, ImageList::Dir::PrevParent);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://b/0");
+    EXPECT_EQ(entry->path(), "exec://b/0");
 
     entry = il.get(entry, ImageList::Dir::PrevParent);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://a/1");
+    EXPECT_EQ(entry->path(), "exec://a/1");
 
     entry = il.get(entry, ImageList::Dir::PrevParent);
     ASSERT_FALSE(entry);
 }
 
+TEST(ImageListTest, ParentRuns)
+{
+    ImageList il;
+    il.set_order(ImageList::Order::None);
+
+    std::vector<std::filesystem::path> paths;
+    for (size_t i = 0; i < 1000; ++i) {
+        paths.emplace_back("exec://" + std::to_string(i / 100) + "/" +
+                           std::to_string(i));
+    }
+    il.add(paths);
+    // incremental insertion into the middle of runs
+    il.set_order(ImageList::Order::Alpha);
+    il.add({ "exec://3/x", "exec://7/x", "exec://z/x" });
+    il.remove(il.find("exec://0/0"));
+    il.remove(il.find("exec://z/x"));
+
+    // compare with linear search
+    const ImageList::EntriesArray all = il.get_all();
+    for (const ImageEntryPtr& entry : all) {
+        ImageEntryPtr next = nullptr;
+        for (size_t i = entry->index() + 1; i < all.size() && !next; ++i) {
+            if (all[i]->dir != entry->dir) {
+                next = all[i];
+            }
+        }
+        EXPECT_EQ(il.get(entry, ImageList::Dir::NextParent), next);
+
+        ImageEntryPtr prev = nullptr;
+        for (size_t i = entry->index(); i > 0 && !prev; --i) {
+            if (all[i - 1]->dir != entry->dir) {
+                prev = all[i - 1];
+            }
+        }
+        EXPECT_EQ(il.get(entry, ImageList::Dir::PrevParent), prev);
+    }
+
+    const auto dirs = il.get_dirs();
+    EXPECT_EQ(dirs.size(), 10UL);
+    for (const auto& [path, count] : dirs) {
+        if (path == "exec://0") {
+            EXPECT_EQ(count, 99UL);
+        } else if (path == "exec://3" || path == "exec://7") {
+            EXPECT_EQ(count, 101UL);
+        } else {
+            EXPECT_EQ(count, 100UL);
+        }
+    }
+}
+
 TEST(ImageListTest, GetRandom)
 {
     ImageList il;
@@ -580,11 +1011,11 @@ TEST(ImageListTest, Advance)
 
     entry = il.get(il.get(nullptr, ImageList::Dir::First), 2);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://3");
+    EXPECT_EQ(entry->path(), "exec://3");
 
     entry = il.get(entry, -2);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://1");
+    EXPECT_EQ(entry->path(), "exec://1");
 }
 
 TEST(ImageListTest, Distance)
@@ -607,6 +1038,23 @@ TEST(ImageListTest, Distance)
     EXPECT_EQ(il.distance(entry, il.get(nullptr, ImageList::Dir::First)), -1);
 }
 
+TEST(ImageListTest, GetRange)
+{
+    ImageList il;
+    il.set_order(ImageList::Order::None);
+    il.add({ "exec://1", "exec://2", "exec://3", "exec://4" });
+
+    const std::vector<std::filesystem::path> expected_mid = { "exec://2",
+                                                              "exec://3" };
+    EXPECT_ILEQ(il.get_range(1, 2), expected_mid);
+    const std::vector<std::filesystem::path> expected_end = { "exec://3",
+                                                              "exec://4" };
+    EXPECT_ILEQ(il.get_range(2, 100), expected_end);
+    EXPECT_ILEQ(il.get_range(0, 0), { "exec://1" });
+    EXPECT_ILEQ(il.get_range(4, 5), {});
+    EXPECT_ILEQ(il.get_range(2, 1), {});
+}
+
 TEST(ImageListTest, Find)
 {
     ImageList il;
@@ -615,7 +1063,7 @@ TEST(ImageListTest, Find)
 
     const ImageEntryPtr entry = il.find("exec://2");
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://2");
+    EXPECT_EQ(entry->path(), "exec://2");
 
     ASSERT_FALSE(il.find("exec://22"));
     ASSERT_FALSE(il.find(""));
@@ -723,31 +1171,31 @@ TEST(ImageListTest, GetRemoved)
 
     entry = il.get(removed, ImageList::Dir::Next);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://3");
+    EXPECT_EQ(entry->path(), "exec://3");
 
     entry = il.get(removed, ImageList::Dir::Prev);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://1");
+    EXPECT_EQ(entry->path(), "exec://1");
 
     entry = il.get(removed, ImageList::Dir::NextParent);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://3");
+    EXPECT_EQ(entry->path(), "exec://3");
 
     entry = il.get(removed, ImageList::Dir::PrevParent);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://1");
+    EXPECT_EQ(entry->path(), "exec://1");
 
     entry = il.get(nullptr, ImageList::Dir::First);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://0");
+    EXPECT_EQ(entry->path(), "exec://0");
 
     entry = il.get(nullptr, ImageList::Dir::Last);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://4");
+    EXPECT_EQ(entry->path(), "exec://4");
 
     entry = il.get(removed, ImageList::Dir::Random);
     ASSERT_TRUE(entry);
-    EXPECT_NE(entry->path, "exec://2");
+    EXPECT_NE(entry->path(), "exec://2");
 
     // remove first
     removed = il.find("exec://0");
@@ -756,11 +1204,11 @@ TEST(ImageListTest, GetRemoved)
 
     entry = il.get(removed, ImageList::Dir::Next);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://1");
+    EXPECT_EQ(entry->path(), "exec://1");
 
     entry = il.get(removed, ImageList::Dir::Prev);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://1");
+    EXPECT_EQ(entry->path(), "exec://1");
 
     // remove last
     removed = il.find("exec://4");
@@ -769,9 +1217,9 @@ TEST(ImageListTest, GetRemoved)
 
     entry = il.get(removed, ImageList::Dir::Next);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://3");
+    EXPECT_EQ(entry->path(), "exec://3");
 
     entry = il.get(removed, ImageList::Dir::Prev);
     ASSERT_TRUE(entry);
-    EXPECT_EQ(entry->path, "exec://3");
+    EXPECT_EQ(entry->path(), "exec://3");
 }
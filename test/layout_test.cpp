@@ -77,7 +77,7 @@ protected:
                 printf("%zu | ", index / layout.get_columns());
             }
             const std::string path =
-                it.img->path.string().substr(strlen(ImageEntry::SRC_EXEC));
+                it.img->path().string().substr(strlen(ImageEntry::SRC_EXEC));
             if (it.img == layout.get_selected()) {
                 printf("\x1b[1;97m");
             }
@@ -102,14 +102,14 @@ TEST_F(LayoutTest, BaseScheme)
 {
     InitLayout(15);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
     ASSERT_EQ(layout.get_columns(), 5UL);
     ASSERT_EQ(layout.get_rows(), 4UL);
 
     const ImageEntryPtr selection = layout.get_selected();
     ASSERT_TRUE(selection);
     ASSERT_TRUE(!selection->removed);
-    ASSERT_EQ(selection->path, std::string(ImageEntry::SRC_EXEC) + "0");
+    ASSERT_EQ(selection->path(), std::string(ImageEntry::SRC_EXEC) + "0");
 
     ASSERT_EQ(layout.get_scheme().size(), 15UL);
     for (const auto& it : layout.get_scheme()) {
@@ -125,7 +125,7 @@ TEST_F(LayoutTest, SelectByImage)
 {
     InitLayout(30);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
 
     const Layout::Thumbnail* th = Select(5);
 
@@ -135,7 +135,7 @@ TEST_F(LayoutTest, SelectByImage)
     ASSERT_EQ(th->col, 0UL);
     ASSERT_EQ(th->row, 1UL);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
 }
 
 TEST_F(LayoutTest, SelectFirstLast)
@@ -146,15 +146,15 @@ TEST_F(LayoutTest, SelectFirstLast)
     ASSERT_EQ(scheme.size(), 20UL);
 
     ASSERT_TRUE(layout.select(Layout::Last));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://10");
-    ASSERT_EQ(layout.get_selected()->path, "exec://26");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://10");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://26");
     auto [col0, row0] = GetSelection();
     ASSERT_EQ(col0, 1UL);
     ASSERT_EQ(row0, 3UL);
 
     ASSERT_TRUE(layout.select(Layout::First));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
-    ASSERT_EQ(layout.get_selected()->path, "exec://0");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://0");
     auto [col1, row1] = GetSelection();
     ASSERT_EQ(col1, 0UL);
     ASSERT_EQ(row1, 0UL);
@@ -166,16 +166,16 @@ TEST_F(LayoutTest, SelectLeft)
 
     Select(16);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://5");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://5");
     auto [col0, row0] = GetSelection();
     ASSERT_EQ(col0, 1UL);
     ASSERT_EQ(row0, 2UL);
 
     for (ssize_t i = 15; i >= 0; --i) {
         ASSERT_TRUE(layout.select(Layout::Left));
-        ASSERT_EQ(layout.get_scheme()[0].img->path,
+        ASSERT_EQ(layout.get_scheme()[0].img->path(),
                   i >= 5 ? "exec://5" : "exec://0");
-        ASSERT_EQ(layout.get_selected()->path, "exec://" + std::to_string(i));
+        ASSERT_EQ(layout.get_selected()->path(), "exec://" + std::to_string(i));
     }
     ASSERT_FALSE(layout.select(Layout::Left));
 }
@@ -186,16 +186,16 @@ TEST_F(LayoutTest, SelectRight)
 
     Select(16);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://5");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://5");
     auto [col0, row0] = GetSelection();
     ASSERT_EQ(col0, 1UL);
     ASSERT_EQ(row0, 2UL);
 
     for (size_t i = 17; i < 30; ++i) {
         ASSERT_TRUE(layout.select(Layout::Right));
-        ASSERT_EQ(layout.get_scheme()[0].img->path,
+        ASSERT_EQ(layout.get_scheme()[0].img->path(),
                   i < 25 ? "exec://5" : "exec://10");
-        ASSERT_EQ(layout.get_selected()->path, "exec://" + std::to_string(i));
+        ASSERT_EQ(layout.get_selected()->path(), "exec://" + std::to_string(i));
     }
     ASSERT_FALSE(layout.select(Layout::Right));
 }
@@ -206,35 +206,35 @@ TEST_F(LayoutTest, SelectUp)
 
     Select(18);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://5");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://5");
     auto [col0, row0] = GetSelection();
     ASSERT_EQ(col0, 3UL);
     ASSERT_EQ(row0, 2UL);
 
     ASSERT_TRUE(layout.select(Layout::Up));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://5");
-    ASSERT_EQ(layout.get_selected()->path, "exec://13");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://5");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://13");
     auto [col1, row1] = GetSelection();
     ASSERT_EQ(col1, 3UL);
     ASSERT_EQ(row1, 1UL);
 
     ASSERT_TRUE(layout.select(Layout::Up));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://5");
-    ASSERT_EQ(layout.get_selected()->path, "exec://8");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://5");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://8");
     auto [col2, row2] = GetSelection();
     ASSERT_EQ(col2, 3UL);
     ASSERT_EQ(row2, 0UL);
 
     ASSERT_TRUE(layout.select(Layout::Up));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
-    ASSERT_EQ(layout.get_selected()->path, "exec://3");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://3");
     auto [col3, row3] = GetSelection();
     ASSERT_EQ(col3, 3UL);
     ASSERT_EQ(row3, 0UL);
 
     ASSERT_TRUE(layout.select(Layout::Up));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
-    ASSERT_EQ(layout.get_selected()->path, "exec://0");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://0");
     auto [col4, row4] = GetSelection();
     ASSERT_EQ(col4, 0UL);
     ASSERT_EQ(row4, 0UL);
@@ -248,28 +248,28 @@ TEST_F(LayoutTest, SelectDown)
 
     Select(18);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://5");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://5");
     auto [col0, row0] = GetSelection();
     ASSERT_EQ(col0, 3UL);
     ASSERT_EQ(row0, 2UL);
 
     ASSERT_TRUE(layout.select(Layout::Down));
-    EXPECT_EQ(layout.get_scheme()[0].img->path, "exec://5");
-    EXPECT_EQ(layout.get_selected()->path, "exec://23");
+    EXPECT_EQ(layout.get_scheme()[0].img->path(), "exec://5");
+    EXPECT_EQ(layout.get_selected()->path(), "exec://23");
     auto [col1, row1] = GetSelection();
     EXPECT_EQ(col1, 3UL);
     EXPECT_EQ(row1, 3UL);
 
     ASSERT_TRUE(layout.select(Layout::Down));
-    EXPECT_EQ(layout.get_scheme()[0].img->path, "exec://10");
-    EXPECT_EQ(layout.get_selected()->path, "exec://28");
+    EXPECT_EQ(layout.get_scheme()[0].img->path(), "exec://10");
+    EXPECT_EQ(layout.get_selected()->path(), "exec://28");
     auto [col2, row2] = GetSelection();
     EXPECT_EQ(col2, 3UL);
     EXPECT_EQ(row2, 3UL);
 
     ASSERT_TRUE(layout.select(Layout::Down));
-    EXPECT_EQ(layout.get_scheme()[0].img->path, "exec://10");
-    EXPECT_EQ(layout.get_selected()->path, "exec://29");
+    EXPECT_EQ(layout.get_scheme()[0].img->path(), "exec://10");
+    EXPECT_EQ(layout.get_selected()->path(), "exec://29");
     auto [col3, row3] = GetSelection();
     EXPECT_EQ(col3, 4UL);
     EXPECT_EQ(row3, 3UL);
@@ -283,15 +283,15 @@ TEST_F(LayoutTest, SelectPageUp)
 
     Select(34);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://20");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://20");
 
     ASSERT_TRUE(layout.select(Layout::PgUp));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
-    ASSERT_EQ(layout.get_selected()->path, "exec://14");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://14");
 
     ASSERT_TRUE(layout.select(Layout::PgUp));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
-    ASSERT_EQ(layout.get_selected()->path, "exec://0");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://0");
 
     ASSERT_FALSE(layout.select(Layout::PgUp));
 }
@@ -302,17 +302,56 @@ TEST_F(LayoutTest, SelectPageDown)
 
     Select(6);
 
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://0");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://0");
 
     ASSERT_TRUE(layout.select(Layout::PgDown));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://20");
-    ASSERT_EQ(layout.get_selected()->path, "exec://26");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://20");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://26");
 
     ASSERT_TRUE(layout.select(Layout::PgDown));
-    ASSERT_EQ(layout.get_scheme()[0].img->path, "exec://20");
-    ASSERT_EQ(layout.get_selected()->path, "exec://39");
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://20");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://39");
 
     ASSERT_FALSE(layout.select(Layout::PgDown));
 }
 
+TEST_F(LayoutTest, SmoothScroll)
+{
+    InitLayout(100);
+    layout.set_smooth(true);
+
+    // 5 columns, 15 px per row, layout height is 305 px
+    ASSERT_EQ(layout.get_scroll(), 0UL);
+    ASSERT_EQ(layout.get_scheme().size(), 20UL);
+    ASSERT_EQ(layout.get_scheme()[0].pos.y, 5);
+    ASSERT_EQ(layout.get_selected()->path(), "exec://0");
+
+    // partially visible rows, selection is moved to the first visible row
+    ASSERT_TRUE(layout.scroll(7));
+    ASSERT_EQ(layout.get_scroll(), 7UL);
+    ASSERT_EQ(layout.get_scheme().size(), 25UL);
+    ASSERT_EQ(layout.get_scheme()[0].pos.y, -2);
+    ASSERT_EQ(layout.get_selected()->path(), "exec://5");
+
+    // top limit
+    ASSERT_TRUE(layout.scroll(-100));
+    ASSERT_EQ(layout.get_scroll(), 0UL);
+    ASSERT_FALSE(layout.scroll(-1));
+    ASSERT_EQ(layout.get_selected()->path(), "exec://5");
+
+    // bottom limit
+    ASSERT_TRUE(layout.scroll(10000));
+    ASSERT_EQ(layout.get_scroll(), 245UL);
+    ASSERT_EQ(layout.get_scheme()[0].img->path(), "exec://80");
+    ASSERT_EQ(layout.get_selected()->path(), "exec://80");
+    ASSERT_FALSE(layout.scroll(1));
+
+    // viewport follows the selection
+    ASSERT_TRUE(layout.select(Layout::First));
+    ASSERT_EQ(layout.get_scroll(), 0UL);
+    ASSERT_TRUE(layout.select(Layout::Last));
+    ASSERT_EQ(layout.get_scroll(), 245UL);
+    ASSERT_EQ(layout.get_selected()->path(), "exec://99");
+}
+
 // NOLINTEND(readability-function-cognitive-complexity)
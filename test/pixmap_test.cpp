@@ -132,6 +132,39 @@ TEST(PixmapTest, FlipHorizontal)
     EXPECT_PMEQ(pm, expect);
 }
 
+TEST(PixmapTest, ShiftVertical)
+{
+    // clang-format off
+    std::vector<argb_t> source = {
+        1, 1, 1,
+        2, 2, 2,
+        3, 3, 3,
+        4, 4, 4,
+    };
+    const std::vector<argb_t> expect_up = {
+        3, 3, 3,
+        4, 4, 4,
+        3, 3, 3,
+        4, 4, 4,
+    };
+    const std::vector<argb_t> expect_down = {
+        3, 3, 3,
+        3, 3, 3,
+        4, 4, 4,
+        3, 3, 3,
+    };
+    // clang-format on
+
+    Pixmap pm;
+    pm.attach(Pixmap::ARGB, 3, 4, source.data());
+    pm.shift_vertical(-2);
+    EXPECT_PMEQ(pm, expect_up);
+    pm.shift_vertical(1);
+    EXPECT_PMEQ(pm, expect_down);
+    pm.shift_vertical(4); // out of range
+    EXPECT_PMEQ(pm, expect_down);
+}
+
 TEST(PixmapTest, FlipVertical)
 {
     // clang-format off
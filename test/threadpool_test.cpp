@@ -5,6 +5,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <set>
@@ -20,6 +21,18 @@ TEST(ThreadPoolTest, Size)
         EXPECT_GE(tp.size(), 1UL);
         EXPECT_LE(tp.size(), 8UL);
     }
+    {
+        const ThreadPool tp(ThreadPool::MAX_THREADS);
+        EXPECT_GE(tp.size(), 1UL);
+        EXPECT_LE(tp.size(),
+                  std::max(1U, std::thread::hardware_concurrency()));
+    }
+    {
+        const ThreadPool tp(ThreadPool::MAX_THREADS, 2);
+        EXPECT_GE(tp.size(), 1UL);
+        EXPECT_LE(tp.size(),
+                  std::max(1U, std::thread::hardware_concurrency() * 2));
+    }
 }
 
 TEST(ThreadPoolTest, SingleTaskExecution)
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: MIT
+// Copyright (C) 2026 Artem Senichev <artemsen@gmail.com>
+
+#include "thumbcache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Create image entry with specified index
+ImageEntryPtr make_entry(const size_t index)
+{
+    ImageEntryPtr entry = std::make_shared<ImageEntry>();
+    entry->set_index(index);
+    return entry;
+}
+
+// Create thumbnail pixmap (10x10 ARGB)
+Pixmap make_thumb()
+{
+    Pixmap pm;
+    pm.create(Pixmap::ARGB, 10, 10);
+    return pm;
+}
+
+// Size of thumbnail created by make_thumb
+const size_t THUMB_BYTES = sizeof(Pixmap) + 10 * 10 * 4;
+
+} // anonymous namespace
+
+TEST(ThumbCacheTest, PutGet)
+{
+    ThumbCache cache(THUMB_BYTES * 10);
+    const ImageEntryPtr entry = make_entry(1);
+
+    EXPECT_FALSE(cache.contains(entry));
+    EXPECT_EQ(cache.get(entry), nullptr);
+
+    cache.put(entry, make_thumb());
+    EXPECT_TRUE(cache.contains(entry));
+    const ThumbCache::Thumbnail thumb = cache.get(entry);
+    ASSERT_NE(thumb, nullptr);
+    EXPECT_EQ(thumb->width(), 10UL);
+    EXPECT_EQ(cache.count(), 1UL);
+    EXPECT_EQ(cache.get_size(), THUMB_BYTES);
+
+    // replace
+    cache.put(entry, make_thumb());
+    EXPECT_EQ(cache.count(), 1UL);
+    EXPECT_EQ(cache.get_size(), THUMB_BYTES);
+    EXPECT_NE(cache.get(entry), thumb);
+    EXPECT_EQ(thumb->width(), 10UL); // still valid for the holder
+}
+
+TEST(ThumbCacheTest, Erase)
+{
+    ThumbCache cache(THUMB_BYTES * 10);
+    const ImageEntryPtr entry1 = make_entry(1);
+    const ImageEntryPtr entry2 = make_entry(2);
+
+    cache.put(entry1, make_thumb());
+    cache.put(entry2, make_thumb());
+    EXPECT_EQ(cache.count(), 2UL);
+
+    cache.erase(entry1);
+    EXPECT_FALSE(cache.contains(entry1));
+    EXPECT_TRUE(cache.contains(entry2));
+    EXPECT_EQ(cache.get_size(), THUMB_BYTES);
+
+    cache.clear();
+    EXPECT_EQ(cache.count(), 0UL);
+    EXPECT_EQ(cache.get_size(), 0UL);
+}
+
+TEST(ThumbCacheTest, Evict)
+{
+    ThumbCache cache(THUMB_BYTES * 4);
+    cache.set_focus(5, 6, 5);
+
+    std::vector<ImageEntryPtr> entries;
+    for (size_t i = 0; i < 10; ++i) {
+        entries.emplace_back(make_entry(i));
+    }
+    // put focused entries first, then the rest from the nearest
+    for (const size_t i : { 5, 6, 4, 7, 3, 8, 0 }) {
+        cache.put(entries[i], make_thumb());
+    }
+
+    EXPECT_LE(cache.get_size(), cache.get_limit());
+    EXPECT_EQ(cache.get_evicted(), 7UL - cache.count());
+    EXPECT_TRUE(cache.contains(entries[5]));
+    EXPECT_TRUE(cache.contains(entries[6]));
+    EXPECT_FALSE(cache.contains(entries[0]));
+
+    // focused entries are never evicted
+    cache.set_limit(0);
+    EXPECT_EQ(cache.count(), 2UL);
+    EXPECT_TRUE(cache.contains(entries[5]));
+    EXPECT_TRUE(cache.contains(entries[6]));
+}
+
+TEST(ThumbCacheTest, Concurrent)
+{
+    constexpr size_t threads = 4;
+    constexpr size_t per_thread = 100;
+
+    ThumbCache cache(THUMB_BYTES * threads * per_thread);
+    std::vector<ImageEntryPtr> entries;
+    for (size_t i = 0; i < threads * per_thread; ++i) {
+        entries.emplace_back(make_entry(i));
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&cache, &entries, t]() {
+            for (size_t i = 0; i < per_thread; ++i) {
+                const ImageEntryPtr& entry = entries[t * per_thread + i];
+                cache.put(entry, make_thumb());
+                EXPECT_NE(cache.get(entry), nullptr);
+            }
+        });
+    }
+    for (auto& it : workers) {
+        it.join();
+    }
+
+    EXPECT_EQ(cache.count(), threads * per_thread);
+    EXPECT_EQ(cache.get_size(), THUMB_BYTES * threads * per_thread);
+}